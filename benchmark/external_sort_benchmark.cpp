@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <sorting_algorithms/sort.hpp>
+
+// a fixed-size record of 100 bytes, sorted by its key
+struct Record {
+    std::uint64_t key;
+    char payload[92];
+
+    bool operator<(const Record& other) const noexcept { return key < other.key; }
+};
+
+static const std::string input_path  = "external_sort_benchmark_input.bin";
+static const std::string output_path = "external_sort_benchmark_output.bin";
+
+// writes a file of random records, one block at a time
+static void write_random_file(std::size_t bytes) {
+    static std::mt19937_64 gen(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+
+    auto file = std::fopen(input_path.c_str(), "wb");
+
+    std::vector<Record> block(1 << 14);
+    for (std::size_t written = 0; written < bytes; written += block.size() * sizeof(Record)) {
+        for (auto& record : block) {
+            record.key = gen();
+        }
+        std::fwrite(block.data(), sizeof(Record), block.size(), file);
+    }
+
+    std::fclose(file);
+}
+
+// state.range(0) is the size of the file and state.range(1) is the memory budget, both in MiB
+static void bm_external_sort(benchmark::State& state) {
+    const std::size_t file_size     = static_cast<std::size_t>(state.range(0)) << 20;
+    const std::size_t memory_budget = static_cast<std::size_t>(state.range(1)) << 20;
+
+    write_random_file(file_size);
+
+    for (auto _ : state) {
+        alg::external_sort<Record>(input_path, output_path, memory_budget);
+    }
+
+    // reported as MB/s of input sorted
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * file_size));
+
+    std::remove(input_path.c_str());
+    std::remove(output_path.c_str());
+}
+
+///////////////////
+// external sort //
+///////////////////
+BENCHMARK(bm_external_sort)
+    ->Name("sorting a file of 100-byte records - alg::external_sort (file MiB/budget MiB)")
+    ->Args({64, 256})
+    ->Args({256, 256})
+    ->Args({256, 64})
+    ->Args({1024, 64})
+    ->Args({1024, 16})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -1,7 +1,15 @@
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <limits>
+#include <new>
+#include <numeric>
 #include <random>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -16,12 +24,58 @@ struct SortFunc { enum type {
     selection_sort,
     heap_sort,
     merge_sort,
+    merge_sort_buf,
+    in_place_merge_sort,
+    tim_sort,
     quick_sort,
+    pdq_sort,
     counting_sort,
     radix_sort,
     bucket_sort,
+    string_sort,
+    sort_by_key,
+    stable_sort_by_key,
+    argsort,
+    stable_argsort,
     std_stable_sort,
     std_sort,
+    alg_sort,
+    alg_stable_sort,
+}; };
+
+struct PartitionFunc { enum type {
+    alg_partition,
+    lomuto_partition,
+    std_partition,
+}; };
+
+struct MergeFunc { enum type {
+    multiway_merge,
+    stable_multiway_merge,
+    parallel_multiway_merge,
+    binary_merges,
+}; };
+
+struct SelectFunc { enum type {
+    quick_select,
+    multi_select,
+    std_nth_element,
+    std_sort,
+}; };
+
+struct TopKFunc { enum type {
+    top_k,
+    top_k_batch,
+    partial_sort,
+    std_partial_sort,
+}; };
+
+struct HeapFunc { enum type {
+    classic,
+    bottom_up,
+    four_ary,
+    eight_ary,
+    std_heap,
 }; };
 
 struct TestType { enum type {
@@ -31,6 +85,60 @@ struct TestType { enum type {
 }; };
 // clang-format on
 
+// counts the heap memory in use, so the benchmarks can report the peak extra memory of the algorithms
+static std::atomic<std::size_t> allocated_bytes(0);
+static std::atomic<std::size_t> peak_allocated_bytes(0);
+static std::atomic<std::size_t> allocation_count(0);
+
+// every allocation is prefixed with its size, padded to keep the alignment of the returned pointer
+constexpr std::size_t ALLOCATION_HEADER_SIZE = alignof(std::max_align_t);
+
+void* operator new(std::size_t size) {
+    auto ptr = static_cast<char*>(std::malloc(size + ALLOCATION_HEADER_SIZE));
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<std::size_t*>(ptr) = size;
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    auto in_use = allocated_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    auto peak   = peak_allocated_bytes.load(std::memory_order_relaxed);
+    while (in_use > peak && !peak_allocated_bytes.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+    }
+
+    return ptr + ALLOCATION_HEADER_SIZE;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto base = static_cast<char*>(ptr) - ALLOCATION_HEADER_SIZE;
+    allocated_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(base), std::memory_order_relaxed);
+    std::free(base);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    operator delete(ptr);
+}
+
+/**
+ * @brief resets the peak to the memory currently in use and returns it
+ */
+static std::size_t reset_peak_allocated_bytes() {
+    auto in_use = allocated_bytes.load(std::memory_order_relaxed);
+    peak_allocated_bytes.store(in_use, std::memory_order_relaxed);
+    return in_use;
+}
+
 template <class Int>
 static std::vector<Int> random_int_vector(std::size_t size, Int max = std::numeric_limits<Int>::max()) {
     static std::mt19937 gen(std::chrono::high_resolution_clock::now().time_since_epoch().count());
@@ -88,6 +196,27 @@ inline std::vector<std::string> random_vector<std::string>(std::size_t size) {
     return vec;
 }
 
+template <>
+inline std::vector<double> random_vector<double>(std::size_t size) {
+    return random_double_vector(size, -1e9, 1e9);
+}
+
+template <>
+inline std::vector<float> random_vector<float>(std::size_t size) {
+    auto doubles = random_double_vector(size, -1e9, 1e9);
+    return std::vector<float>(doubles.begin(), doubles.end());
+}
+
+template <>
+inline std::vector<std::uint64_t> random_vector<std::uint64_t>(std::size_t size) {
+    return random_int_vector<std::uint64_t>(size);
+}
+
+template <class RandomAccessIterator>
+static void pdq_sort(RandomAccessIterator first, RandomAccessIterator last) {
+    alg::quick_sort(first, last, alg::QuickSortMode::PatternDefeating());
+}
+
 template <class T>
 static void bm_sort_vector(benchmark::State& state) {
     using iterator      = typename std::vector<T>::iterator;
@@ -99,7 +228,9 @@ static void bm_sort_vector(benchmark::State& state) {
         {SortFunc::selection_sort,  alg::selection_sort},
         {SortFunc::heap_sort,       alg::heap_sort     },
         {SortFunc::merge_sort,      alg::merge_sort    },
+        {SortFunc::tim_sort,        alg::tim_sort      },
         {SortFunc::quick_sort,      alg::quick_sort    },
+        {SortFunc::pdq_sort,        pdq_sort           },
         {SortFunc::std_stable_sort, std::stable_sort   },
         {SortFunc::std_sort,        std::sort          },
     };
@@ -162,11 +293,11 @@ static void bm_counting_sort_and_radix_sort(benchmark::State& state) {
         switch (func) {
         case SortFunc::counting_sort:
             state.ResumeTiming();
-            alg::counting_sort(tmp.begin(), tmp.end(), MAX);
+            alg::counting_sort(tmp.begin(), tmp.end());
             break;
         case SortFunc::radix_sort:
             state.ResumeTiming();
-            alg::radix_sort(tmp.begin(), tmp.end(), MAX);
+            alg::radix_sort(tmp.begin(), tmp.end());
             break;
         case SortFunc::std_sort:
             state.ResumeTiming();
@@ -180,6 +311,118 @@ static void bm_counting_sort_and_radix_sort(benchmark::State& state) {
     }
 }
 
+// state.range(0) is the input pattern: random, sorted, reverse sorted, values in [0, 1000] or 4 distinct values
+// far apart, and state.range(1) is the sort function
+static void bm_adaptive_sort(benchmark::State& state) {
+    static std::mt19937 gen(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+
+    const auto func = static_cast<SortFunc::type>(state.range(1));
+
+    std::vector<int> vec(1000000);
+    std::uniform_int_distribution<int> dist;
+    switch (state.range(0)) {
+    case 0:
+        std::generate(vec.begin(), vec.end(), [&dist]() { return dist(gen); });
+        break;
+    case 1:
+        std::iota(vec.begin(), vec.end(), 0);
+        break;
+    case 2:
+        std::iota(vec.rbegin(), vec.rend(), 0);
+        break;
+    case 3:
+        std::generate(vec.begin(), vec.end(), [&dist]() { return dist(gen) % 1001; });
+        break;
+    default:
+        std::generate(vec.begin(), vec.end(), [&dist]() { return dist(gen) % 4 * 500000000; });
+        break;
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp = vec;
+        state.ResumeTiming();
+
+        switch (func) {
+        case SortFunc::alg_sort:
+            alg::sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::alg_stable_sort:
+            alg::stable_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::std_sort:
+            std::sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::std_stable_sort:
+            std::stable_sort(tmp.begin(), tmp.end());
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+// state.range(0) is the number of doubles, uniformly distributed around zero, and state.range(1) is the sort function
+static void bm_radix_sort_doubles(benchmark::State& state) {
+    static std::mt19937_64 gen(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+
+    const auto func = static_cast<SortFunc::type>(state.range(1));
+
+    std::uniform_real_distribution<> dist(-1e9, 1e9);
+    std::vector<double> vec(static_cast<std::size_t>(state.range(0)));
+    std::generate(vec.begin(), vec.end(), [&dist]() { return dist(gen); });
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp = vec;
+        state.ResumeTiming();
+
+        switch (func) {
+        case SortFunc::radix_sort:
+            alg::radix_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::std_sort:
+            std::sort(tmp.begin(), tmp.end());
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+// state.range(0) is the number of distinct values, which are clustered around 10^12, and state.range(1) is the
+// sort function
+static void bm_counting_sort_wide(benchmark::State& state) {
+    static std::mt19937_64 gen(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+
+    const auto width = state.range(0);
+    const auto func  = static_cast<SortFunc::type>(state.range(1));
+
+    std::uniform_int_distribution<std::int64_t> dist(1000000000000 - width / 2, 1000000000000 + (width - 1) / 2);
+    std::vector<std::int64_t> vec(1000000);
+    std::generate(vec.begin(), vec.end(), [&dist]() { return dist(gen); });
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp = vec;
+        state.ResumeTiming();
+
+        switch (func) {
+        case SortFunc::counting_sort:
+            alg::counting_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::radix_sort:
+            alg::radix_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::std_sort:
+            std::sort(tmp.begin(), tmp.end());
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
 static void bm_bucket_sort(benchmark::State& state) {
     static auto vec       = random_double_vector(10000U, 0.0, 1.0);
     static auto last_test = TestType::shuffled;
@@ -222,6 +465,729 @@ static void bm_bucket_sort(benchmark::State& state) {
     }
 }
 
+// state.range(0) is whether the values are exponentially distributed (otherwise uniformly in [-10^9, 10^9))
+// and state.range(1) is the sort function
+static void bm_bucket_sort_distributions(benchmark::State& state) {
+    static std::mt19937_64 gen(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+
+    const auto func = static_cast<SortFunc::type>(state.range(1));
+
+    std::vector<double> vec(1000000);
+    if (state.range(0)) {
+        std::exponential_distribution<> dist(3.0);
+        std::generate(vec.begin(), vec.end(), [&dist]() { return dist(gen); });
+    } else {
+        std::uniform_real_distribution<> dist(-1e9, 1e9);
+        std::generate(vec.begin(), vec.end(), [&dist]() { return dist(gen); });
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp = vec;
+        state.ResumeTiming();
+
+        switch (func) {
+        case SortFunc::bucket_sort:
+            alg::bucket_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::std_sort:
+            std::sort(tmp.begin(), tmp.end());
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+static void bm_parallel_merge_sort(benchmark::State& state) {
+    static auto vec = random_int_vector<int>(1U << 23);
+
+    auto policy = alg::parallel_policy(static_cast<unsigned>(state.range(0)));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp = vec;
+        state.ResumeTiming();
+
+        alg::merge_sort(policy, tmp.begin(), tmp.end());
+    }
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void bm_parallel_quick_sort(benchmark::State& state) {
+    auto vec    = random_int_vector<int>(state.range(0));
+    auto policy = alg::parallel_policy();
+
+    auto tmp   = vec;
+    auto start = std::chrono::steady_clock::now();
+    std::sort(tmp.begin(), tmp.end());
+    auto std_sort_seconds = seconds_since(start);
+
+    double total_seconds = 0.0;
+    for (auto _ : state) {
+        tmp   = vec;
+        start = std::chrono::steady_clock::now();
+        alg::quick_sort(policy, tmp.begin(), tmp.end());
+
+        auto seconds = seconds_since(start);
+        state.SetIterationTime(seconds);
+        total_seconds += seconds;
+    }
+
+    state.counters["threads"]              = policy.thread_count;
+    state.counters["speedup_vs_std::sort"] = std_sort_seconds / (total_seconds / state.iterations());
+}
+
+template <class Int>
+static void bm_parallel_radix_sort(benchmark::State& state) {
+    static auto vec = random_int_vector<Int>(1U << 24);
+
+    auto policy = alg::parallel_policy(static_cast<unsigned>(state.range(0)));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp = vec;
+        state.ResumeTiming();
+
+        alg::radix_sort(policy, tmp.begin(), tmp.end());
+    }
+
+    state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(Int));
+}
+
+static void bm_string_sort(benchmark::State& state) {
+    // log and URL like keys which share long prefixes
+    static const std::string prefixes[] = {
+        "https://example.com/api/v1/users/",
+        "https://example.com/api/v1/orders/",
+        "https://example.com/static/images/",
+        "2022-03-14 12:00:00.000 INFO  [main] com.example.service.",
+    };
+    static auto vec = []() {
+        std::vector<std::string> vec(10000U);
+        for (std::size_t i = 0; i < vec.size(); ++i) {
+            vec[i] = prefixes[i % 4] + random_string(0U, 50U);
+        }
+        return vec;
+    }();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+
+        auto func = static_cast<SortFunc::type>(state.range(0));
+        auto tmp  = vec;
+
+        switch (func) {
+        case SortFunc::string_sort:
+            state.ResumeTiming();
+            alg::string_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::merge_sort:
+            state.ResumeTiming();
+            alg::merge_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::quick_sort:
+            state.ResumeTiming();
+            alg::quick_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::std_stable_sort:
+            state.ResumeTiming();
+            std::stable_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::std_sort:
+            state.ResumeTiming();
+            std::sort(tmp.begin(), tmp.end());
+            break;
+        }
+    }
+}
+
+static void bm_sort_by_key(benchmark::State& state) {
+    // timestamps parsed from log lines, so deriving the key of an element is expensive
+    static auto vec = []() {
+        auto timestamps = random_int_vector<std::int64_t>(100000U);
+        std::vector<std::string> vec(timestamps.size());
+        for (std::size_t i = 0; i < vec.size(); ++i) {
+            vec[i] = std::to_string(timestamps[i]) + " INFO  [main] com.example.service";
+        }
+        return vec;
+    }();
+
+    auto timestamp         = [](const std::string& line) { return std::stoll(line); };
+    auto compare_timestamp = [&timestamp](const std::string& a, const std::string& b) {
+        return timestamp(a) < timestamp(b);
+    };
+
+    for (auto _ : state) {
+        state.PauseTiming();
+
+        auto func = static_cast<SortFunc::type>(state.range(0));
+        auto tmp  = vec;
+
+        switch (func) {
+        case SortFunc::sort_by_key:
+            state.ResumeTiming();
+            alg::sort_by_key(tmp.begin(), tmp.end(), timestamp);
+            break;
+        case SortFunc::stable_sort_by_key:
+            state.ResumeTiming();
+            alg::stable_sort_by_key(tmp.begin(), tmp.end(), timestamp);
+            break;
+        case SortFunc::quick_sort:
+            state.ResumeTiming();
+            alg::quick_sort(tmp.begin(), tmp.end(), compare_timestamp);
+            break;
+        case SortFunc::std_stable_sort:
+            state.ResumeTiming();
+            std::stable_sort(tmp.begin(), tmp.end(), compare_timestamp);
+            break;
+        case SortFunc::std_sort:
+            state.ResumeTiming();
+            std::sort(tmp.begin(), tmp.end(), compare_timestamp);
+            break;
+        }
+    }
+}
+
+// a record with a key and a payload, of Size bytes in total
+template <std::size_t Size>
+struct Record {
+    std::int64_t key;
+    char payload[Size - sizeof(std::int64_t)];
+
+    bool operator<(const Record& other) const noexcept { return key < other.key; }
+};
+
+template <std::size_t Size>
+static void bm_indirect_sort(benchmark::State& state) {
+    static auto vec = []() {
+        auto keys = random_int_vector<std::int64_t>(100000U);
+        std::vector<Record<Size>> vec(keys.size());
+        for (std::size_t i = 0; i < vec.size(); ++i) {
+            vec[i].key = keys[i];
+        }
+        return vec;
+    }();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+
+        auto func = static_cast<SortFunc::type>(state.range(0));
+        auto tmp  = vec;
+
+        switch (func) {
+        case SortFunc::quick_sort:
+            state.ResumeTiming();
+            alg::quick_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::merge_sort:
+            state.ResumeTiming();
+            alg::merge_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::argsort: {
+            state.ResumeTiming();
+            auto indices = alg::argsort(tmp.begin(), tmp.end());
+            alg::apply_permutation(tmp.begin(), tmp.end(), indices.begin());
+            break;
+        }
+        case SortFunc::stable_argsort: {
+            state.ResumeTiming();
+            auto indices = alg::stable_argsort(tmp.begin(), tmp.end());
+            alg::apply_permutation(tmp.begin(), tmp.end(), indices.begin());
+            break;
+        }
+        }
+    }
+}
+
+static void bm_co_sort(benchmark::State& state) {
+    // a key column and three payload columns
+    static const auto keys     = random_int_vector<std::uint64_t>(1000000U);
+    static const auto payload1 = random_int_vector<std::uint64_t>(keys.size());
+    static const auto payload2 = random_vector<double>(keys.size());
+    static const auto payload3 = random_int_vector<std::uint32_t>(keys.size());
+
+    struct Row {
+        std::uint64_t key;
+        std::uint64_t payload1;
+        double payload2;
+        std::uint32_t payload3;
+    };
+
+    for (auto _ : state) {
+        state.PauseTiming();
+
+        auto func     = static_cast<SortFunc::type>(state.range(0));
+        auto tmp_keys = keys;
+        auto tmp1     = payload1;
+        auto tmp2     = payload2;
+        auto tmp3     = payload3;
+
+        switch (func) {
+        case SortFunc::radix_sort:
+            state.ResumeTiming();
+            alg::co_sort(alg::CoSortMode::Radix(), tmp_keys.begin(), tmp_keys.end(), tmp1.begin(), tmp2.begin(),
+                         tmp3.begin());
+            break;
+        case SortFunc::merge_sort:
+            state.ResumeTiming();
+            alg::co_sort(alg::CoSortMode::Merge(), tmp_keys.begin(), tmp_keys.end(), tmp1.begin(), tmp2.begin(),
+                         tmp3.begin());
+            break;
+        default: {
+            // builds an array of structs, sorts it and splits it again
+            state.ResumeTiming();
+            std::vector<Row> rows(tmp_keys.size());
+            for (std::size_t i = 0; i < rows.size(); ++i) {
+                rows[i] = {tmp_keys[i], tmp1[i], tmp2[i], tmp3[i]};
+            }
+            std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.key < b.key; });
+            for (std::size_t i = 0; i < rows.size(); ++i) {
+                tmp_keys[i] = rows[i].key;
+                tmp1[i]     = rows[i].payload1;
+                tmp2[i]     = rows[i].payload2;
+                tmp3[i]     = rows[i].payload3;
+            }
+            break;
+        }
+        }
+    }
+}
+
+// state.range(0) is the number of runs and state.range(1) is the merge function
+static void bm_multiway_merge(benchmark::State& state) {
+    using iterator = std::vector<int>::iterator;
+
+    const auto k    = static_cast<std::size_t>(state.range(0));
+    const auto func = static_cast<MergeFunc::type>(state.range(1));
+
+    auto vec = random_int_vector<int>(1U << 22);
+    std::vector<std::pair<std::size_t, std::size_t>> bounds;
+    for (std::size_t i = 0; i < k; ++i) {
+        bounds.push_back({vec.size() * i / k, vec.size() * (i + 1) / k});
+        std::sort(vec.begin() + bounds.back().first, vec.begin() + bounds.back().second);
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp = vec;
+        std::vector<int> result(tmp.size());
+        std::vector<std::pair<iterator, iterator>> ranges;
+        for (auto& bound : bounds) {
+            ranges.push_back({tmp.begin() + bound.first, tmp.begin() + bound.second});
+        }
+        state.ResumeTiming();
+
+        switch (func) {
+        case MergeFunc::multiway_merge:
+            alg::multiway_merge(ranges.begin(), ranges.end(), result.begin());
+            break;
+        case MergeFunc::stable_multiway_merge:
+            alg::stable_multiway_merge(ranges.begin(), ranges.end(), result.begin());
+            break;
+        case MergeFunc::parallel_multiway_merge:
+            alg::multiway_merge(alg::parallel_policy(), ranges.begin(), ranges.end(), result.begin());
+            break;
+        case MergeFunc::binary_merges:
+            // merges the runs pairwise, one pass over all of the elements per level
+            for (std::size_t width = 1; width < k; width *= 2) {
+                for (std::size_t i = 0; i + width < k; i += 2 * width) {
+                    auto first = bounds[i].first;
+                    auto mid   = bounds[i + width].first;
+                    auto last  = bounds[std::min(i + 2 * width, k) - 1].second;
+                    alg::merge(tmp.begin() + first, tmp.begin() + mid, tmp.begin() + mid, tmp.begin() + last,
+                               result.begin() + first);
+                    std::copy(result.begin() + first, result.begin() + last, tmp.begin() + first);
+                }
+            }
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+// state.range(0) is the size, state.range(1) is the select function and state.range(2) is whether
+// the elements have only a few distinct values
+static void bm_select(benchmark::State& state) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    const auto func = static_cast<SelectFunc::type>(state.range(1));
+
+    auto vec = random_int_vector<int>(size);
+    if (state.range(2)) {
+        for (auto& x : vec) {
+            x &= 15;
+        }
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp = vec;
+        auto kth = tmp.begin() + size / 2;
+        state.ResumeTiming();
+
+        switch (func) {
+        case SelectFunc::quick_select:
+            alg::quick_select(tmp.begin(), kth, tmp.end());
+            break;
+        case SelectFunc::std_nth_element:
+            std::nth_element(tmp.begin(), kth, tmp.end());
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// state.range(0) is the size and state.range(1) is the select function
+static void bm_quantiles(benchmark::State& state) {
+    using iterator = std::vector<int>::iterator;
+
+    const auto size = static_cast<std::size_t>(state.range(0));
+    const auto func = static_cast<SelectFunc::type>(state.range(1));
+
+    // p50, p90, p99 and p999 of latencies
+    auto vec = random_int_vector<int>(size);
+    const std::vector<std::size_t> ranks = {size / 2, size * 9 / 10, size * 99 / 100, size * 999 / 1000};
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp = vec;
+        std::vector<iterator> kths;
+        for (auto rank : ranks) {
+            kths.push_back(tmp.begin() + rank);
+        }
+        state.ResumeTiming();
+
+        switch (func) {
+        case SelectFunc::multi_select:
+            alg::multi_select(tmp.begin(), tmp.end(), kths.begin(), kths.end());
+            break;
+        case SelectFunc::quick_select:
+            // every call partitions the whole range again
+            for (auto kth : kths) {
+                alg::quick_select(tmp.begin(), kth, tmp.end());
+            }
+            break;
+        case SelectFunc::std_nth_element:
+            for (auto kth : kths) {
+                std::nth_element(tmp.begin(), kth, tmp.end());
+            }
+            break;
+        case SelectFunc::std_sort:
+            std::sort(tmp.begin(), tmp.end());
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// state.range(0) is the size and state.range(1) is the heap variant
+static void bm_heap_sort(benchmark::State& state) {
+    const auto vec  = random_int_vector<int>(static_cast<std::size_t>(state.range(0)));
+    const auto func = static_cast<HeapFunc::type>(state.range(1));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp = vec;
+        state.ResumeTiming();
+
+        switch (func) {
+        case HeapFunc::classic:
+            alg::heap_sort(tmp.begin(), tmp.end(), alg::HeapMode::Classic());
+            break;
+        case HeapFunc::bottom_up:
+            alg::heap_sort(tmp.begin(), tmp.end(), alg::HeapMode::BottomUp());
+            break;
+        case HeapFunc::four_ary:
+            alg::heap_sort(tmp.begin(), tmp.end(), alg::HeapMode::DAry<4>());
+            break;
+        case HeapFunc::eight_ary:
+            alg::heap_sort(tmp.begin(), tmp.end(), alg::HeapMode::DAry<8>());
+            break;
+        case HeapFunc::std_heap:
+            std::make_heap(tmp.begin(), tmp.end());
+            std::sort_heap(tmp.begin(), tmp.end());
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+// state.range(0) is k and state.range(1) is the top-k function
+static void bm_top_k(benchmark::State& state) {
+    static const auto vec = random_int_vector<int>(10000000U);
+
+    const auto k    = static_cast<std::size_t>(state.range(0));
+    const auto func = static_cast<TopKFunc::type>(state.range(1));
+
+    for (auto _ : state) {
+        switch (func) {
+        case TopKFunc::top_k: {
+            // the stream is pushed one element at a time
+            alg::top_k<int> accumulator(k);
+            for (auto x : vec) {
+                accumulator.push(x);
+            }
+            benchmark::DoNotOptimize(accumulator.take_sorted());
+            break;
+        }
+        case TopKFunc::top_k_batch: {
+            alg::top_k<int> accumulator(k);
+            accumulator.push(vec.begin(), vec.end());
+            benchmark::DoNotOptimize(accumulator.take_sorted());
+            break;
+        }
+        case TopKFunc::partial_sort: {
+            state.PauseTiming();
+            auto tmp = vec;
+            state.ResumeTiming();
+            alg::partial_sort(tmp.begin(), tmp.begin() + k, tmp.end());
+            break;
+        }
+        case TopKFunc::std_partial_sort: {
+            state.PauseTiming();
+            auto tmp = vec;
+            state.ResumeTiming();
+            std::partial_sort(tmp.begin(), tmp.begin() + k, tmp.end());
+            break;
+        }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+// state.range(0) is the sort function and state.range(1) is whether a sort_context is reused between the calls
+static void bm_small_batches(benchmark::State& state) {
+    constexpr std::size_t BATCH_SIZE  = 256;
+    constexpr std::size_t BATCH_COUNT = 1000;
+    constexpr unsigned MAX_VALUE      = 1000;
+
+    static const auto vec = random_int_vector<unsigned>(BATCH_SIZE * BATCH_COUNT, MAX_VALUE);
+
+    const auto func        = static_cast<SortFunc::type>(state.range(0));
+    const auto use_context = state.range(1) != 0;
+
+    alg::sort_context context;
+    std::size_t allocations = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp                = vec;
+        auto allocations_before = allocation_count.load(std::memory_order_relaxed);
+        state.ResumeTiming();
+
+        for (auto batch = tmp.begin(); batch != tmp.end(); batch += BATCH_SIZE) {
+            switch (func) {
+            case SortFunc::merge_sort:
+                if (use_context) {
+                    alg::merge_sort(context, batch, batch + BATCH_SIZE);
+                } else {
+                    alg::merge_sort(batch, batch + BATCH_SIZE);
+                }
+                break;
+            case SortFunc::in_place_merge_sort:
+                if (use_context) {
+                    alg::in_place_merge_sort(context, batch, batch + BATCH_SIZE);
+                } else {
+                    alg::in_place_merge_sort(batch, batch + BATCH_SIZE);
+                }
+                break;
+            case SortFunc::counting_sort:
+                if (use_context) {
+                    alg::counting_sort(context, batch, batch + BATCH_SIZE);
+                } else {
+                    alg::counting_sort(batch, batch + BATCH_SIZE);
+                }
+                break;
+            case SortFunc::radix_sort:
+                if (use_context) {
+                    alg::radix_sort(context, batch, batch + BATCH_SIZE);
+                } else {
+                    alg::radix_sort(batch, batch + BATCH_SIZE);
+                }
+                break;
+            }
+        }
+
+        state.PauseTiming();
+        allocations += allocation_count.load(std::memory_order_relaxed) - allocations_before;
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * vec.size());
+    state.counters["allocations_per_call"] =
+        static_cast<double>(allocations) / static_cast<double>(state.iterations() * BATCH_COUNT);
+}
+
+static void bm_nearly_sorted(benchmark::State& state) {
+    // a sorted sequence with 1% of new elements appended, like a log that is sorted again after each batch
+    static auto vec = []() {
+        auto vec = random_int_vector<int>(1000000U);
+        std::sort(vec.begin(), vec.end() - vec.size() / 100);
+        return vec;
+    }();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+
+        auto func = static_cast<SortFunc::type>(state.range(0));
+        auto tmp  = vec;
+
+        switch (func) {
+        case SortFunc::tim_sort:
+            state.ResumeTiming();
+            alg::tim_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::merge_sort:
+            state.ResumeTiming();
+            alg::merge_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::std_stable_sort:
+            state.ResumeTiming();
+            std::stable_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::std_sort:
+            state.ResumeTiming();
+            std::sort(tmp.begin(), tmp.end());
+            break;
+        }
+    }
+}
+
+static void bm_bounded_memory_merge_sort(benchmark::State& state) {
+    using value_type = std::pair<int, int>;
+
+    static auto vec = []() {
+        auto keys = random_int_vector<int>(1000000U);
+        std::vector<value_type> vec(keys.size());
+        for (std::size_t i = 0; i < vec.size(); ++i) {
+            vec[i] = {keys[i], static_cast<int>(i)};
+        }
+        return vec;
+    }();
+
+    auto func        = static_cast<SortFunc::type>(state.range(0));
+    auto buffer_size = static_cast<std::size_t>(state.range(1));
+
+    std::size_t peak_extra_bytes = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp      = vec;
+        auto baseline = reset_peak_allocated_bytes();
+        state.ResumeTiming();
+
+        switch (func) {
+        case SortFunc::merge_sort:
+            alg::merge_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::merge_sort_buf: {
+            std::vector<value_type> buffer(buffer_size);
+            alg::merge_sort_buf(tmp.begin(), tmp.end(), buffer.data(), buffer.size());
+            break;
+        }
+        case SortFunc::in_place_merge_sort:
+            alg::in_place_merge_sort(tmp.begin(), tmp.end());
+            break;
+        case SortFunc::std_stable_sort:
+            std::stable_sort(tmp.begin(), tmp.end());
+            break;
+        }
+
+        state.PauseTiming();
+        peak_extra_bytes = std::max(peak_extra_bytes, peak_allocated_bytes.load() - baseline);
+        state.ResumeTiming();
+    }
+
+    state.counters["peak_extra_bytes"] = static_cast<double>(peak_extra_bytes);
+}
+
+template <class T>
+static void bm_small_sorts(benchmark::State& state) {
+    constexpr std::size_t CHUNK_SIZE = 16U;
+
+    // small records sorted one group at a time, where the sorting of the leaves dominates
+    static auto vec = []() {
+        auto keys = random_int_vector<int32_t>(1U << 20);
+        return std::vector<T>(keys.begin(), keys.end());
+    }();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp  = vec;
+        auto func = static_cast<SortFunc::type>(state.range(0));
+        state.ResumeTiming();
+
+        for (auto it = tmp.begin(); it != tmp.end(); it += CHUNK_SIZE) {
+            switch (func) {
+            case SortFunc::quick_sort:
+                alg::quick_sort(it, it + CHUNK_SIZE);
+                break;
+            case SortFunc::insertion_sort:
+                alg::insertion_sort(it, it + CHUNK_SIZE);
+                break;
+            case SortFunc::std_sort:
+                std::sort(it, it + CHUNK_SIZE);
+                break;
+            }
+        }
+    }
+}
+
+template <class T>
+static void bm_partition(benchmark::State& state) {
+    static auto vec = random_vector<T>(1000000U);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp   = vec;
+        auto pivot = tmp.begin() + tmp.size() / 2;
+        auto func  = static_cast<PartitionFunc::type>(state.range(0));
+        state.ResumeTiming();
+
+        switch (func) {
+        case PartitionFunc::alg_partition:
+            benchmark::DoNotOptimize(alg::partition(tmp.begin(), pivot, tmp.end(), std::less<T>()));
+            break;
+        case PartitionFunc::lomuto_partition:
+            std::iter_swap(pivot, tmp.end() - 1);
+            benchmark::DoNotOptimize(extra::partition_lomuto_scheme(tmp.begin(), tmp.end(), std::less<T>()));
+            break;
+        case PartitionFunc::std_partition:
+            auto pivot_value = *pivot;
+            benchmark::DoNotOptimize(
+                std::partition(tmp.begin(), tmp.end(), [pivot_value](const T& a) { return a < pivot_value; }));
+            break;
+        }
+    }
+}
+
+template <class T>
+static void bm_numeric_sort(benchmark::State& state) {
+    auto vec = random_vector<T>(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto tmp  = vec;
+        auto func = static_cast<SortFunc::type>(state.range(1));
+        state.ResumeTiming();
+
+        switch (func) {
+        case SortFunc::quick_sort:
+            alg::quick_sort(tmp.begin(), tmp.end());
+            break;
+        default:
+            std::sort(tmp.begin(), tmp.end());
+            break;
+        }
+    }
+}
+
 //////////////////////
 // std::vector<int> //
 //////////////////////
@@ -245,10 +1211,18 @@ BENCHMARK(bm_sort_vector<int>)
     ->Name("sorting std::vector<int> of size 10000 - shuffled - alg::merge_sort")
     ->Args({TestType::shuffled, SortFunc::merge_sort});
 
+BENCHMARK(bm_sort_vector<int>)
+    ->Name("sorting std::vector<int> of size 10000 - shuffled - alg::tim_sort")
+    ->Args({TestType::shuffled, SortFunc::tim_sort});
+
 BENCHMARK(bm_sort_vector<int>)
     ->Name("sorting std::vector<int> of size 10000 - shuffled - alg::quick_sort")
     ->Args({TestType::shuffled, SortFunc::quick_sort});
 
+BENCHMARK(bm_sort_vector<int>)
+    ->Name("sorting std::vector<int> of size 10000 - shuffled - alg::quick_sort (pattern-defeating)")
+    ->Args({TestType::shuffled, SortFunc::pdq_sort});
+
 BENCHMARK(bm_sort_vector<int>)
     ->Name("sorting std::vector<int> of size 10000 - shuffled - std::stable_sort")
     ->Args({TestType::shuffled, SortFunc::std_stable_sort});
@@ -277,10 +1251,18 @@ BENCHMARK(bm_sort_vector<int>)
     ->Name("sorting std::vector<int> of size 10000 - sorted - alg::merge_sort")
     ->Args({TestType::sorted, SortFunc::merge_sort});
 
+BENCHMARK(bm_sort_vector<int>)
+    ->Name("sorting std::vector<int> of size 10000 - sorted - alg::tim_sort")
+    ->Args({TestType::sorted, SortFunc::tim_sort});
+
 BENCHMARK(bm_sort_vector<int>)
     ->Name("sorting std::vector<int> of size 10000 - sorted - alg::quick_sort")
     ->Args({TestType::sorted, SortFunc::quick_sort});
 
+BENCHMARK(bm_sort_vector<int>)
+    ->Name("sorting std::vector<int> of size 10000 - sorted - alg::quick_sort (pattern-defeating)")
+    ->Args({TestType::sorted, SortFunc::pdq_sort});
+
 BENCHMARK(bm_sort_vector<int>)
     ->Name("sorting std::vector<int> of size 10000 - sorted - std::stable_sort")
     ->Args({TestType::sorted, SortFunc::std_stable_sort});
@@ -309,10 +1291,18 @@ BENCHMARK(bm_sort_vector<int>)
     ->Name("sorting std::vector<int> of size 10000 - reverse sorted - alg::merge_sort")
     ->Args({TestType::reverse_sorted, SortFunc::merge_sort});
 
+BENCHMARK(bm_sort_vector<int>)
+    ->Name("sorting std::vector<int> of size 10000 - reverse sorted - alg::tim_sort")
+    ->Args({TestType::reverse_sorted, SortFunc::tim_sort});
+
 BENCHMARK(bm_sort_vector<int>)
     ->Name("sorting std::vector<int> of size 10000 - reverse sorted - alg::quick_sort")
     ->Args({TestType::reverse_sorted, SortFunc::quick_sort});
 
+BENCHMARK(bm_sort_vector<int>)
+    ->Name("sorting std::vector<int> of size 10000 - reverse sorted - alg::quick_sort (pattern-defeating)")
+    ->Args({TestType::reverse_sorted, SortFunc::pdq_sort});
+
 BENCHMARK(bm_sort_vector<int>)
     ->Name("sorting std::vector<int> of size 10000 - reverse sorted - std::stable_sort")
     ->Args({TestType::reverse_sorted, SortFunc::std_stable_sort});
@@ -344,10 +1334,18 @@ BENCHMARK(bm_sort_vector<std::string>)
     ->Name("sorting std::vector<std::string> of size 10000 - shuffled - alg::merge_sort")
     ->Args({TestType::shuffled, SortFunc::merge_sort});
 
+BENCHMARK(bm_sort_vector<std::string>)
+    ->Name("sorting std::vector<std::string> of size 10000 - shuffled - alg::tim_sort")
+    ->Args({TestType::shuffled, SortFunc::tim_sort});
+
 BENCHMARK(bm_sort_vector<std::string>)
     ->Name("sorting std::vector<std::string> of size 10000 - shuffled - alg::quick_sort")
     ->Args({TestType::shuffled, SortFunc::quick_sort});
 
+BENCHMARK(bm_sort_vector<std::string>)
+    ->Name("sorting std::vector<std::string> of size 10000 - shuffled - alg::quick_sort (pattern-defeating)")
+    ->Args({TestType::shuffled, SortFunc::pdq_sort});
+
 BENCHMARK(bm_sort_vector<std::string>)
     ->Name("sorting std::vector<std::string> of size 10000 - shuffled - std::stable_sort")
     ->Args({TestType::shuffled, SortFunc::std_stable_sort});
@@ -376,10 +1374,18 @@ BENCHMARK(bm_sort_vector<std::string>)
     ->Name("sorting std::vector<std::string> of size 10000 - sorted - alg::merge_sort")
     ->Args({TestType::sorted, SortFunc::merge_sort});
 
+BENCHMARK(bm_sort_vector<std::string>)
+    ->Name("sorting std::vector<std::string> of size 10000 - sorted - alg::tim_sort")
+    ->Args({TestType::sorted, SortFunc::tim_sort});
+
 BENCHMARK(bm_sort_vector<std::string>)
     ->Name("sorting std::vector<std::string> of size 10000 - sorted - alg::quick_sort")
     ->Args({TestType::sorted, SortFunc::quick_sort});
 
+BENCHMARK(bm_sort_vector<std::string>)
+    ->Name("sorting std::vector<std::string> of size 10000 - sorted - alg::quick_sort (pattern-defeating)")
+    ->Args({TestType::sorted, SortFunc::pdq_sort});
+
 BENCHMARK(bm_sort_vector<std::string>)
     ->Name("sorting std::vector<std::string> of size 10000 - sorted - std::stable_sort")
     ->Args({TestType::sorted, SortFunc::std_stable_sort});
@@ -408,10 +1414,18 @@ BENCHMARK(bm_sort_vector<std::string>)
     ->Name("sorting std::vector<std::string> of size 10000 - reverse sorted - alg::merge_sort")
     ->Args({TestType::reverse_sorted, SortFunc::merge_sort});
 
+BENCHMARK(bm_sort_vector<std::string>)
+    ->Name("sorting std::vector<std::string> of size 10000 - reverse sorted - alg::tim_sort")
+    ->Args({TestType::reverse_sorted, SortFunc::tim_sort});
+
 BENCHMARK(bm_sort_vector<std::string>)
     ->Name("sorting std::vector<std::string> of size 10000 - reverse sorted - alg::quick_sort")
     ->Args({TestType::reverse_sorted, SortFunc::quick_sort});
 
+BENCHMARK(bm_sort_vector<std::string>)
+    ->Name("sorting std::vector<std::string> of size 10000 - reverse sorted - alg::quick_sort (pattern-defeating)")
+    ->Args({TestType::reverse_sorted, SortFunc::pdq_sort});
+
 BENCHMARK(bm_sort_vector<std::string>)
     ->Name("sorting std::vector<std::string> of size 10000 - reverse sorted - std::stable_sort")
     ->Args({TestType::reverse_sorted, SortFunc::std_stable_sort});
@@ -471,6 +1485,134 @@ BENCHMARK(bm_counting_sort_and_radix_sort)
     ->Name("sorting std::vector<unsigned> of size 10000 and max element <= 1000 - reverse sorted - std::sort")
     ->Args({TestType::reverse_sorted, SortFunc::std_sort});
 
+/////////////////////////
+// std::vector<double> //
+/////////////////////////
+BENCHMARK(bm_sort_vector<double>)
+    ->Name("sorting std::vector<double> of size 10000 - shuffled - alg::quick_sort")
+    ->Args({TestType::shuffled, SortFunc::quick_sort});
+
+BENCHMARK(bm_sort_vector<double>)
+    ->Name("sorting std::vector<double> of size 10000 - shuffled - std::sort")
+    ->Args({TestType::shuffled, SortFunc::std_sort});
+
+///////////////////////////
+// ranges of 16 elements //
+///////////////////////////
+BENCHMARK(bm_small_sorts<int32_t>)
+    ->Name("sorting std::vector<int32_t> of size 2^20 in ranges of 16 elements - alg::quick_sort (sorting network)")
+    ->Arg(SortFunc::quick_sort);
+
+BENCHMARK(bm_small_sorts<int32_t>)
+    ->Name("sorting std::vector<int32_t> of size 2^20 in ranges of 16 elements - alg::insertion_sort")
+    ->Arg(SortFunc::insertion_sort);
+
+BENCHMARK(bm_small_sorts<int32_t>)
+    ->Name("sorting std::vector<int32_t> of size 2^20 in ranges of 16 elements - std::sort")
+    ->Arg(SortFunc::std_sort);
+
+BENCHMARK(bm_small_sorts<int64_t>)
+    ->Name("sorting std::vector<int64_t> of size 2^20 in ranges of 16 elements - alg::quick_sort (sorting network)")
+    ->Arg(SortFunc::quick_sort);
+
+BENCHMARK(bm_small_sorts<int64_t>)
+    ->Name("sorting std::vector<int64_t> of size 2^20 in ranges of 16 elements - alg::insertion_sort")
+    ->Arg(SortFunc::insertion_sort);
+
+BENCHMARK(bm_small_sorts<int64_t>)
+    ->Name("sorting std::vector<int64_t> of size 2^20 in ranges of 16 elements - std::sort")
+    ->Arg(SortFunc::std_sort);
+
+BENCHMARK(bm_small_sorts<float>)
+    ->Name("sorting std::vector<float> of size 2^20 in ranges of 16 elements - alg::quick_sort (sorting network)")
+    ->Arg(SortFunc::quick_sort);
+
+BENCHMARK(bm_small_sorts<float>)
+    ->Name("sorting std::vector<float> of size 2^20 in ranges of 16 elements - alg::insertion_sort")
+    ->Arg(SortFunc::insertion_sort);
+
+BENCHMARK(bm_small_sorts<float>)
+    ->Name("sorting std::vector<float> of size 2^20 in ranges of 16 elements - std::sort")
+    ->Arg(SortFunc::std_sort);
+
+BENCHMARK(bm_small_sorts<double>)
+    ->Name("sorting std::vector<double> of size 2^20 in ranges of 16 elements - alg::quick_sort (sorting network)")
+    ->Arg(SortFunc::quick_sort);
+
+BENCHMARK(bm_small_sorts<double>)
+    ->Name("sorting std::vector<double> of size 2^20 in ranges of 16 elements - alg::insertion_sort")
+    ->Arg(SortFunc::insertion_sort);
+
+BENCHMARK(bm_small_sorts<double>)
+    ->Name("sorting std::vector<double> of size 2^20 in ranges of 16 elements - std::sort")
+    ->Arg(SortFunc::std_sort);
+
+///////////////
+// partition //
+///////////////
+BENCHMARK(bm_partition<int>)
+    ->Name("partitioning std::vector<int> of size 1000000 - shuffled - alg::partition (block partition)")
+    ->Arg(PartitionFunc::alg_partition);
+
+BENCHMARK(bm_partition<int>)
+    ->Name("partitioning std::vector<int> of size 1000000 - shuffled - Lomuto partition")
+    ->Arg(PartitionFunc::lomuto_partition);
+
+BENCHMARK(bm_partition<int>)
+    ->Name("partitioning std::vector<int> of size 1000000 - shuffled - std::partition")
+    ->Arg(PartitionFunc::std_partition);
+
+BENCHMARK(bm_partition<double>)
+    ->Name("partitioning std::vector<double> of size 1000000 - shuffled - alg::partition (block partition)")
+    ->Arg(PartitionFunc::alg_partition);
+
+BENCHMARK(bm_partition<double>)
+    ->Name("partitioning std::vector<double> of size 1000000 - shuffled - Lomuto partition")
+    ->Arg(PartitionFunc::lomuto_partition);
+
+BENCHMARK(bm_partition<double>)
+    ->Name("partitioning std::vector<double> of size 1000000 - shuffled - std::partition")
+    ->Arg(PartitionFunc::std_partition);
+
+//////////////////////////////
+// sorting arithmetic types //
+//////////////////////////////
+BENCHMARK(bm_numeric_sort<int32_t>)
+    ->Name("sorting shuffled std::vector<int32_t> of size n - alg::quick_sort (vectorized partition)")
+    ->RangeMultiplier(10)
+    ->Ranges({{100000, 100000000}, {SortFunc::quick_sort, SortFunc::quick_sort}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_numeric_sort<int32_t>)
+    ->Name("sorting shuffled std::vector<int32_t> of size n - std::sort")
+    ->RangeMultiplier(10)
+    ->Ranges({{100000, 100000000}, {SortFunc::std_sort, SortFunc::std_sort}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_numeric_sort<float>)
+    ->Name("sorting shuffled std::vector<float> of size n - alg::quick_sort (vectorized partition)")
+    ->RangeMultiplier(10)
+    ->Ranges({{100000, 100000000}, {SortFunc::quick_sort, SortFunc::quick_sort}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_numeric_sort<float>)
+    ->Name("sorting shuffled std::vector<float> of size n - std::sort")
+    ->RangeMultiplier(10)
+    ->Ranges({{100000, 100000000}, {SortFunc::std_sort, SortFunc::std_sort}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_numeric_sort<std::uint64_t>)
+    ->Name("sorting shuffled std::vector<uint64_t> of size n - alg::quick_sort (vectorized partition)")
+    ->RangeMultiplier(10)
+    ->Ranges({{100000, 100000000}, {SortFunc::quick_sort, SortFunc::quick_sort}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_numeric_sort<std::uint64_t>)
+    ->Name("sorting shuffled std::vector<uint64_t> of size n - std::sort")
+    ->RangeMultiplier(10)
+    ->Ranges({{100000, 100000000}, {SortFunc::std_sort, SortFunc::std_sort}})
+    ->Unit(benchmark::kMillisecond);
+
 /////////////////
 // bucket sort //
 /////////////////
@@ -510,4 +1652,468 @@ BENCHMARK(bm_bucket_sort)
     ->Name("sorting std::vector<double> of size 10000 where 0<=vec[i]<1 - reverse sorted - std::sort")
     ->Args({TestType::reverse_sorted, SortFunc::std_sort});
 
+/////////////////////////////////
+// sorting by an expensive key //
+/////////////////////////////////
+BENCHMARK(bm_sort_by_key)
+    ->Name("sorting std::vector<std::string> of size 100000 by a parsed timestamp - alg::sort_by_key")
+    ->Arg(SortFunc::sort_by_key)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_sort_by_key)
+    ->Name("sorting std::vector<std::string> of size 100000 by a parsed timestamp - alg::stable_sort_by_key")
+    ->Arg(SortFunc::stable_sort_by_key)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_sort_by_key)
+    ->Name("sorting std::vector<std::string> of size 100000 by a parsed timestamp - alg::quick_sort with a key comparison")
+    ->Arg(SortFunc::quick_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_sort_by_key)
+    ->Name("sorting std::vector<std::string> of size 100000 by a parsed timestamp - std::stable_sort with a key comparison")
+    ->Arg(SortFunc::std_stable_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_sort_by_key)
+    ->Name("sorting std::vector<std::string> of size 100000 by a parsed timestamp - std::sort with a key comparison")
+    ->Arg(SortFunc::std_sort)
+    ->Unit(benchmark::kMillisecond);
+
+///////////////////////////////////////////////////
+// sorting large records directly and indirectly //
+///////////////////////////////////////////////////
+BENCHMARK(bm_indirect_sort<16>)
+    ->Name("sorting std::vector<Record<16>> of size 100000 - alg::quick_sort")
+    ->Arg(SortFunc::quick_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<16>)
+    ->Name("sorting std::vector<Record<16>> of size 100000 - alg::merge_sort")
+    ->Arg(SortFunc::merge_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<16>)
+    ->Name("sorting std::vector<Record<16>> of size 100000 - alg::argsort + alg::apply_permutation")
+    ->Arg(SortFunc::argsort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<16>)
+    ->Name("sorting std::vector<Record<16>> of size 100000 - alg::stable_argsort + alg::apply_permutation")
+    ->Arg(SortFunc::stable_argsort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<64>)
+    ->Name("sorting std::vector<Record<64>> of size 100000 - alg::quick_sort")
+    ->Arg(SortFunc::quick_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<64>)
+    ->Name("sorting std::vector<Record<64>> of size 100000 - alg::merge_sort")
+    ->Arg(SortFunc::merge_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<64>)
+    ->Name("sorting std::vector<Record<64>> of size 100000 - alg::argsort + alg::apply_permutation")
+    ->Arg(SortFunc::argsort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<64>)
+    ->Name("sorting std::vector<Record<64>> of size 100000 - alg::stable_argsort + alg::apply_permutation")
+    ->Arg(SortFunc::stable_argsort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<256>)
+    ->Name("sorting std::vector<Record<256>> of size 100000 - alg::quick_sort")
+    ->Arg(SortFunc::quick_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<256>)
+    ->Name("sorting std::vector<Record<256>> of size 100000 - alg::merge_sort")
+    ->Arg(SortFunc::merge_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<256>)
+    ->Name("sorting std::vector<Record<256>> of size 100000 - alg::argsort + alg::apply_permutation")
+    ->Arg(SortFunc::argsort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<256>)
+    ->Name("sorting std::vector<Record<256>> of size 100000 - alg::stable_argsort + alg::apply_permutation")
+    ->Arg(SortFunc::stable_argsort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<512>)
+    ->Name("sorting std::vector<Record<512>> of size 100000 - alg::quick_sort")
+    ->Arg(SortFunc::quick_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<512>)
+    ->Name("sorting std::vector<Record<512>> of size 100000 - alg::merge_sort")
+    ->Arg(SortFunc::merge_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<512>)
+    ->Name("sorting std::vector<Record<512>> of size 100000 - alg::argsort + alg::apply_permutation")
+    ->Arg(SortFunc::argsort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_indirect_sort<512>)
+    ->Name("sorting std::vector<Record<512>> of size 100000 - alg::stable_argsort + alg::apply_permutation")
+    ->Arg(SortFunc::stable_argsort)
+    ->Unit(benchmark::kMillisecond);
+
+/////////////////////
+// sorting columns //
+/////////////////////
+BENCHMARK(bm_co_sort)
+    ->Name("sorting a std::vector<uint64_t> of size 1000000 with 3 payload columns - alg::co_sort (radix)")
+    ->Arg(SortFunc::radix_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_co_sort)
+    ->Name("sorting a std::vector<uint64_t> of size 1000000 with 3 payload columns - alg::co_sort (merge)")
+    ->Arg(SortFunc::merge_sort)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_co_sort)
+    ->Name("sorting a std::vector<uint64_t> of size 1000000 with 3 payload columns - std::stable_sort of an array of structs")
+    ->Arg(SortFunc::std_stable_sort)
+    ->Unit(benchmark::kMillisecond);
+
+/////////////////
+// k-way merge //
+/////////////////
+BENCHMARK(bm_multiway_merge)
+    ->Name("merging k sorted runs of 2^22 ints in total - alg::multiway_merge")
+    ->ArgsProduct({{4, 16, 64, 256}, {MergeFunc::multiway_merge}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_multiway_merge)
+    ->Name("merging k sorted runs of 2^22 ints in total - alg::stable_multiway_merge")
+    ->ArgsProduct({{4, 16, 64, 256}, {MergeFunc::stable_multiway_merge}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_multiway_merge)
+    ->Name("merging k sorted runs of 2^22 ints in total - parallel alg::multiway_merge with all threads")
+    ->ArgsProduct({{4, 16, 64, 256}, {MergeFunc::parallel_multiway_merge}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_multiway_merge)
+    ->Name("merging k sorted runs of 2^22 ints in total - alg::merge of pairs of runs")
+    ->ArgsProduct({{4, 16, 64, 256}, {MergeFunc::binary_merges}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+////////////////////////////////////////
+// bucket sort of other distributions //
+////////////////////////////////////////
+BENCHMARK(bm_bucket_sort_distributions)
+    ->Name("sorting 10^6 doubles - alg::bucket_sort (exponential distribution)")
+    ->ArgsProduct({{0, 1}, {SortFunc::bucket_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_bucket_sort_distributions)
+    ->Name("sorting 10^6 doubles - std::sort (exponential distribution)")
+    ->ArgsProduct({{0, 1}, {SortFunc::std_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+///////////////////////////////////////////
+// counting sort of values far from zero //
+///////////////////////////////////////////
+BENCHMARK(bm_counting_sort_wide)
+    ->Name("sorting 10^6 int64_t around 10^12 - alg::counting_sort (distinct values)")
+    ->ArgsProduct({{1000, 65536, 1 << 24}, {SortFunc::counting_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_counting_sort_wide)
+    ->Name("sorting 10^6 int64_t around 10^12 - alg::radix_sort (distinct values)")
+    ->ArgsProduct({{1000, 65536, 1 << 24}, {SortFunc::radix_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_counting_sort_wide)
+    ->Name("sorting 10^6 int64_t around 10^12 - std::sort (distinct values)")
+    ->ArgsProduct({{1000, 65536, 1 << 24}, {SortFunc::std_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+//////////////////////
+// adaptive sorting //
+//////////////////////
+BENCHMARK(bm_adaptive_sort)
+    ->Name("sorting 10^6 ints - alg::sort (random, sorted, reversed, small range, few values)")
+    ->ArgsProduct({{0, 1, 2, 3, 4}, {SortFunc::alg_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_adaptive_sort)
+    ->Name("sorting 10^6 ints - alg::stable_sort (random, sorted, reversed, small range, few values)")
+    ->ArgsProduct({{0, 1, 2, 3, 4}, {SortFunc::alg_stable_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_adaptive_sort)
+    ->Name("sorting 10^6 ints - std::sort (random, sorted, reversed, small range, few values)")
+    ->ArgsProduct({{0, 1, 2, 3, 4}, {SortFunc::std_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_adaptive_sort)
+    ->Name("sorting 10^6 ints - std::stable_sort (random, sorted, reversed, small range, few values)")
+    ->ArgsProduct({{0, 1, 2, 3, 4}, {SortFunc::std_stable_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+//////////////////////////////////
+// radix sort of floating point //
+//////////////////////////////////
+BENCHMARK(bm_radix_sort_doubles)
+    ->Name("sorting doubles in [-10^9, 10^9] - alg::radix_sort")
+    ->ArgsProduct({{1000000, 10000000, 100000000}, {SortFunc::radix_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_radix_sort_doubles)
+    ->Name("sorting doubles in [-10^9, 10^9] - std::sort")
+    ->ArgsProduct({{1000000, 10000000, 100000000}, {SortFunc::std_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/////////////////////////////////////////
+// small batches with a reused context //
+/////////////////////////////////////////
+BENCHMARK(bm_small_batches)
+    ->Name("sorting 1000 batches of 256 unsigned ints - alg::merge_sort (with a sort_context)")
+    ->ArgsProduct({{SortFunc::merge_sort}, {0, 1}});
+
+BENCHMARK(bm_small_batches)
+    ->Name("sorting 1000 batches of 256 unsigned ints - alg::in_place_merge_sort (with a sort_context)")
+    ->ArgsProduct({{SortFunc::in_place_merge_sort}, {0, 1}});
+
+BENCHMARK(bm_small_batches)
+    ->Name("sorting 1000 batches of 256 unsigned ints - alg::counting_sort (with a sort_context)")
+    ->ArgsProduct({{SortFunc::counting_sort}, {0, 1}});
+
+BENCHMARK(bm_small_batches)
+    ->Name("sorting 1000 batches of 256 unsigned ints - alg::radix_sort (with a sort_context)")
+    ->ArgsProduct({{SortFunc::radix_sort}, {0, 1}});
+
+//////////////////////
+// median selection //
+//////////////////////
+BENCHMARK(bm_select)
+    ->Name("selecting the median of std::vector<int> - alg::quick_select (size/few distinct values)")
+    ->ArgsProduct({{10000, 1000000, 10000000}, {SelectFunc::quick_select}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_select)
+    ->Name("selecting the median of std::vector<int> - std::nth_element (size/few distinct values)")
+    ->ArgsProduct({{10000, 1000000, 10000000}, {SelectFunc::std_nth_element}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+///////////////
+// quantiles //
+///////////////
+BENCHMARK(bm_quantiles)
+    ->Name("p50, p90, p99 and p999 of std::vector<int> - alg::multi_select")
+    ->ArgsProduct({{1000000, 10000000}, {SelectFunc::multi_select}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_quantiles)
+    ->Name("p50, p90, p99 and p999 of std::vector<int> - alg::quick_select for each")
+    ->ArgsProduct({{1000000, 10000000}, {SelectFunc::quick_select}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_quantiles)
+    ->Name("p50, p90, p99 and p999 of std::vector<int> - std::nth_element for each")
+    ->ArgsProduct({{1000000, 10000000}, {SelectFunc::std_nth_element}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_quantiles)
+    ->Name("p50, p90, p99 and p999 of std::vector<int> - std::sort")
+    ->ArgsProduct({{1000000, 10000000}, {SelectFunc::std_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+///////////
+// top-k //
+///////////
+BENCHMARK(bm_top_k)
+    ->Name("the k smallest of 10^7 ints in sorted order - alg::top_k, one push per element")
+    ->ArgsProduct({{10, 1000, 100000}, {TopKFunc::top_k}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_top_k)
+    ->Name("the k smallest of 10^7 ints in sorted order - alg::top_k, batch push")
+    ->ArgsProduct({{10, 1000, 100000}, {TopKFunc::top_k_batch}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_top_k)
+    ->Name("the k smallest of 10^7 ints in sorted order - alg::partial_sort")
+    ->ArgsProduct({{10, 1000, 100000}, {TopKFunc::partial_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_top_k)
+    ->Name("the k smallest of 10^7 ints in sorted order - std::partial_sort")
+    ->ArgsProduct({{10, 1000, 100000}, {TopKFunc::std_partial_sort}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+///////////////
+// heap sort //
+///////////////
+BENCHMARK(bm_heap_sort)
+    ->Name("heap sorting ints - alg::heap_sort (classic binary heap)")
+    ->ArgsProduct({{10000, 100000, 1000000, 10000000, 100000000}, {HeapFunc::classic}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_heap_sort)
+    ->Name("heap sorting ints - alg::heap_sort (bottom-up binary heap)")
+    ->ArgsProduct({{10000, 100000, 1000000, 10000000, 100000000}, {HeapFunc::bottom_up}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_heap_sort)
+    ->Name("heap sorting ints - alg::heap_sort (bottom-up 4-ary heap)")
+    ->ArgsProduct({{10000, 100000, 1000000, 10000000, 100000000}, {HeapFunc::four_ary}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_heap_sort)
+    ->Name("heap sorting ints - alg::heap_sort (bottom-up 8-ary heap)")
+    ->ArgsProduct({{10000, 100000, 1000000, 10000000, 100000000}, {HeapFunc::eight_ary}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_heap_sort)
+    ->Name("heap sorting ints - std::make_heap + std::sort_heap")
+    ->ArgsProduct({{10000, 100000, 1000000, 10000000, 100000000}, {HeapFunc::std_heap}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+///////////////////////////////////////
+// strings with long shared prefixes //
+///////////////////////////////////////
+BENCHMARK(bm_string_sort)
+    ->Name("sorting std::vector<std::string> of size 10000 with long shared prefixes - alg::string_sort")
+    ->Arg(SortFunc::string_sort);
+
+BENCHMARK(bm_string_sort)
+    ->Name("sorting std::vector<std::string> of size 10000 with long shared prefixes - alg::merge_sort")
+    ->Arg(SortFunc::merge_sort);
+
+BENCHMARK(bm_string_sort)
+    ->Name("sorting std::vector<std::string> of size 10000 with long shared prefixes - alg::quick_sort")
+    ->Arg(SortFunc::quick_sort);
+
+BENCHMARK(bm_string_sort)
+    ->Name("sorting std::vector<std::string> of size 10000 with long shared prefixes - std::stable_sort")
+    ->Arg(SortFunc::std_stable_sort);
+
+BENCHMARK(bm_string_sort)
+    ->Name("sorting std::vector<std::string> of size 10000 with long shared prefixes - std::sort")
+    ->Arg(SortFunc::std_sort);
+
+/////////////////////////////////////////////
+// sorted with 1% of appended new elements //
+/////////////////////////////////////////////
+BENCHMARK(bm_nearly_sorted)
+    ->Name("sorting std::vector<int> of size 1000000 - sorted with 1% appended elements - alg::tim_sort")
+    ->Arg(SortFunc::tim_sort);
+
+BENCHMARK(bm_nearly_sorted)
+    ->Name("sorting std::vector<int> of size 1000000 - sorted with 1% appended elements - alg::merge_sort")
+    ->Arg(SortFunc::merge_sort);
+
+BENCHMARK(bm_nearly_sorted)
+    ->Name("sorting std::vector<int> of size 1000000 - sorted with 1% appended elements - std::stable_sort")
+    ->Arg(SortFunc::std_stable_sort);
+
+BENCHMARK(bm_nearly_sorted)
+    ->Name("sorting std::vector<int> of size 1000000 - sorted with 1% appended elements - std::sort")
+    ->Arg(SortFunc::std_sort);
+
+///////////////////////////////
+// bounded-memory merge sort //
+///////////////////////////////
+BENCHMARK(bm_bounded_memory_merge_sort)
+    ->Name("sorting std::vector<std::pair<int, int>> of size 1000000 - shuffled - alg::merge_sort")
+    ->Args({SortFunc::merge_sort, 0})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_bounded_memory_merge_sort)
+    ->Name("sorting std::vector<std::pair<int, int>> of size 1000000 - shuffled - alg::in_place_merge_sort")
+    ->Args({SortFunc::in_place_merge_sort, 0})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_bounded_memory_merge_sort)
+    ->Name("sorting std::vector<std::pair<int, int>> of size 1000000 - shuffled - alg::merge_sort_buf with an empty buffer")
+    ->Args({SortFunc::merge_sort_buf, 0})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_bounded_memory_merge_sort)
+    ->Name("sorting std::vector<std::pair<int, int>> of size 1000000 - shuffled - alg::merge_sort_buf with a buffer of 1000 elements")
+    ->Args({SortFunc::merge_sort_buf, 1000})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_bounded_memory_merge_sort)
+    ->Name("sorting std::vector<std::pair<int, int>> of size 1000000 - shuffled - alg::merge_sort_buf with a buffer of 62500 elements")
+    ->Args({SortFunc::merge_sort_buf, 62500})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_bounded_memory_merge_sort)
+    ->Name("sorting std::vector<std::pair<int, int>> of size 1000000 - shuffled - std::stable_sort")
+    ->Args({SortFunc::std_stable_sort, 0})
+    ->Unit(benchmark::kMillisecond);
+
+/////////////////////////
+// parallel merge sort //
+/////////////////////////
+BENCHMARK(bm_parallel_merge_sort)
+    ->Name("sorting std::vector<int> of size 2^23 - shuffled - parallel alg::merge_sort with n threads")
+    ->DenseRange(1, std::max(1U, std::thread::hardware_concurrency()))
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/////////////////////////
+// parallel quick sort //
+/////////////////////////
+BENCHMARK(bm_parallel_quick_sort)
+    ->Name("sorting shuffled std::vector<int> of size n - parallel alg::quick_sort with all threads")
+    ->RangeMultiplier(10)
+    ->Range(1000000, 100000000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+/////////////////////////
+// parallel radix sort //
+/////////////////////////
+BENCHMARK(bm_parallel_radix_sort<std::uint32_t>)
+    ->Name("sorting std::vector<uint32_t> of size 2^24 - shuffled - parallel alg::radix_sort with n threads")
+    ->DenseRange(1, std::max(1U, std::thread::hardware_concurrency()))
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(bm_parallel_radix_sort<std::uint64_t>)
+    ->Name("sorting std::vector<uint64_t> of size 2^24 - shuffled - parallel alg::radix_sort with n threads")
+    ->DenseRange(1, std::max(1U, std::thread::hardware_concurrency()))
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
 BENCHMARK_MAIN();
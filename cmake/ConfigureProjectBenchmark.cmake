@@ -15,4 +15,12 @@ function(Core_ConfigureProjectBenchmark)
     benchmark::benchmark
     SortAlgorithmsLibrary
   )
+
+  set(ExternalSortBenchmarkTargetName ${PROJECT_NAME}ExternalSortBenchmark)
+
+  add_executable(${ExternalSortBenchmarkTargetName} benchmark/external_sort_benchmark.cpp)
+  target_link_libraries(${ExternalSortBenchmarkTargetName} PRIVATE
+    benchmark::benchmark
+    SortAlgorithmsLibrary
+  )
 endfunction()
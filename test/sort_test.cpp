@@ -1,9 +1,23 @@
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <forward_list>
+#include <limits>
 #include <list>
+#include <memory>
+#include <numeric>
 #include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
 
@@ -76,6 +90,50 @@ TEST_CASE("general sorting functions") {
             alg::quick_sort(list.begin(), list.end());
             REQUIRE(std::is_sorted(list.begin(), list.end()));
         }
+        SECTION("bidirectional iterator - sorted") {
+            std::sort(to_sort.begin(), to_sort.end());
+            std::list<int> list(to_sort.begin(), to_sort.end());
+            alg::quick_sort(list.begin(), list.end(), std::greater<int>());
+            REQUIRE(std::is_sorted(list.begin(), list.end(), std::greater<int>()));
+        }
+    }
+    SECTION("quick_sort - pattern-defeating") {
+        alg::QuickSortMode::PatternDefeating mode;
+
+        SECTION("default compare") {
+            alg::quick_sort(to_sort.begin(), to_sort.end(), mode);
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+        SECTION("descending") {
+            alg::quick_sort(to_sort.begin(), to_sort.end(), std::greater<int>(), mode);
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end(), std::greater<int>()));
+        }
+        SECTION("sorted") {
+            std::sort(to_sort.begin(), to_sort.end());
+            alg::quick_sort(to_sort.begin(), to_sort.end(), mode);
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+        SECTION("reverse sorted") {
+            std::sort(to_sort.rbegin(), to_sort.rend());
+            alg::quick_sort(to_sort.begin(), to_sort.end(), mode);
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+        SECTION("sorted with appended elements") {
+            std::sort(to_sort.begin(), to_sort.end() - 10);
+            alg::quick_sort(to_sort.begin(), to_sort.end(), mode);
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+        SECTION("many duplicates") {
+            std::transform(to_sort.begin(), to_sort.end(), to_sort.begin(), [](int a) { return a % 4; });
+            alg::quick_sort(to_sort.begin(), to_sort.end(), mode);
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+        SECTION("organ pipe") {
+            std::sort(to_sort.begin(), to_sort.begin() + to_sort.size() / 2);
+            std::sort(to_sort.begin() + to_sort.size() / 2, to_sort.end(), std::greater<int>());
+            alg::quick_sort(to_sort.begin(), to_sort.end(), mode);
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
     }
     SECTION("heap_sort") {
         SECTION("default compare") {
@@ -89,6 +147,616 @@ TEST_CASE("general sorting functions") {
     }
 }
 
+// checks that no element of a d-ary heap is smaller than one of its children
+template <std::size_t Arity, class T, class Compare>
+static bool is_dary_heap(const std::vector<T>& heap, Compare compare) {
+    for (std::size_t i = 1; i < heap.size(); ++i) {
+        if (compare(heap[(i - 1) / Arity], heap[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <std::size_t Arity>
+static void test_dary_heap() {
+    using mode = alg::HeapMode::DAry<Arity>;
+
+    for (std::size_t size : std::vector<std::size_t>{0, 1, Arity, Arity + 1, Arity * Arity + 2, 1000}) {
+        std::vector<int> vec(size);
+        std::uniform_int_distribution<> dist(0, static_cast<int>(size));
+        std::generate(vec.begin(), vec.end(), [&dist]() { return dist(gen); });
+
+        auto sorted = vec;
+        std::sort(sorted.begin(), sorted.end());
+
+        SECTION("make_heap & sort_heap, size = " + std::to_string(size)) {
+            alg::make_heap(vec.begin(), vec.end(), mode());
+            REQUIRE(is_dary_heap<Arity>(vec, std::less<int>()));
+
+            alg::sort_heap(vec.begin(), vec.end(), mode());
+            REQUIRE(vec == sorted);
+        }
+        SECTION("heap_sort, size = " + std::to_string(size)) {
+            alg::heap_sort(vec.begin(), vec.end(), mode());
+            REQUIRE(vec == sorted);
+        }
+        SECTION("heap_sort descending, size = " + std::to_string(size)) {
+            alg::make_heap(vec.begin(), vec.end(), std::greater<int>(), mode());
+            REQUIRE(is_dary_heap<Arity>(vec, std::greater<int>()));
+
+            alg::heap_sort(vec.begin(), vec.end(), std::greater<int>(), mode());
+            REQUIRE(std::equal(sorted.rbegin(), sorted.rend(), vec.begin()));
+        }
+        SECTION("heap_sort of sorted and reverse sorted ranges, size = " + std::to_string(size)) {
+            auto tmp = sorted;
+            alg::heap_sort(tmp.begin(), tmp.end(), mode());
+            REQUIRE(tmp == sorted);
+
+            std::reverse(tmp.begin(), tmp.end());
+            alg::heap_sort(tmp.begin(), tmp.end(), mode());
+            REQUIRE(tmp == sorted);
+        }
+    }
+
+    SECTION("strings") {
+        std::vector<std::string> strings(500);
+        std::generate(strings.begin(), strings.end(), []() { return std::to_string(gen()); });
+
+        alg::heap_sort(strings.begin(), strings.end(), mode());
+        REQUIRE(std::is_sorted(strings.begin(), strings.end()));
+    }
+    SECTION("move-only elements") {
+        std::vector<std::unique_ptr<int>> vec;
+        for (int i = 0; i < 500; ++i) {
+            vec.emplace_back(new int(static_cast<int>(gen() % 100)));
+        }
+        auto compare = [](const std::unique_ptr<int>& a, const std::unique_ptr<int>& b) { return *a < *b; };
+
+        alg::heap_sort(vec.begin(), vec.end(), compare, mode());
+        REQUIRE(std::is_sorted(vec.begin(), vec.end(), compare));
+    }
+}
+
+TEST_CASE("heap variants") {
+    SECTION("bottom-up binary heap") {
+        test_dary_heap<2>();
+    }
+    SECTION("4-ary heap") {
+        test_dary_heap<4>();
+    }
+    SECTION("8-ary heap") {
+        test_dary_heap<8>();
+    }
+    SECTION("classic binary heap") {
+        std::vector<int> vec(1000);
+        std::generate(vec.begin(), vec.end(), []() { return static_cast<int>(gen() % 1000); });
+
+        alg::make_heap(vec.begin(), vec.end(), alg::HeapMode::Classic());
+        REQUIRE(std::is_heap(vec.begin(), vec.end()));
+
+        alg::sort_heap(vec.begin(), vec.end(), alg::HeapMode::Classic());
+        REQUIRE(std::is_sorted(vec.begin(), vec.end()));
+    }
+    SECTION("the bottom-up binary heap is the heap of std::make_heap") {
+        std::vector<int> vec(1000);
+        std::generate(vec.begin(), vec.end(), []() { return static_cast<int>(gen() % 1000); });
+
+        alg::make_heap(vec.begin(), vec.end(), alg::HeapMode::BottomUp());
+        REQUIRE(std::is_heap(vec.begin(), vec.end()));
+
+        std::sort_heap(vec.begin(), vec.end());
+        REQUIRE(std::is_sorted(vec.begin(), vec.end()));
+    }
+}
+
+TEST_CASE("tim_sort") {
+    // large enough to have many runs and to trigger the galloping mode
+    std::vector<std::pair<int, int>> to_sort(100000);
+
+    std::uniform_int_distribution<> dist(0, 1000);
+    for (std::size_t i = 0; i < to_sort.size(); ++i) {
+        to_sort[i] = {dist(gen), static_cast<int>(i)};
+    }
+
+    auto compare_keys = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; };
+
+    SECTION("stable") {
+        alg::tim_sort(to_sort.begin(), to_sort.end(), compare_keys);
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("default compare") {
+        alg::tim_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("descending") {
+        alg::tim_sort(to_sort.begin(), to_sort.end(), std::greater<std::pair<int, int>>());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end(), std::greater<std::pair<int, int>>()));
+    }
+    SECTION("sorted") {
+        std::sort(to_sort.begin(), to_sort.end());
+        alg::tim_sort(to_sort.begin(), to_sort.end(), compare_keys);
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("reverse sorted") {
+        // only the keys are descending, so equivalent elements must not be reversed
+        std::stable_sort(to_sort.begin(), to_sort.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+            return a.first > b.first;
+        });
+        alg::tim_sort(to_sort.begin(), to_sort.end(), compare_keys);
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("sorted with appended elements") {
+        std::sort(to_sort.begin(), to_sort.end() - 100);
+        alg::tim_sort(to_sort.begin(), to_sort.end(), compare_keys);
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("interleaved runs") {
+        auto chunk = to_sort.size() / 10;
+        for (std::size_t i = 0; i < to_sort.size(); i += chunk) {
+            std::sort(to_sort.begin() + i, to_sort.begin() + std::min(i + chunk, to_sort.size()));
+        }
+        alg::tim_sort(to_sort.begin(), to_sort.end(), compare_keys);
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("short range") {
+        to_sort.resize(20);
+        alg::tim_sort(to_sort.begin(), to_sort.end(), compare_keys);
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+}
+
+TEST_CASE("bounded-memory merge sort") {
+    using value_type = std::pair<int, int>;
+
+    std::vector<value_type> to_sort(20000);
+
+    std::uniform_int_distribution<> dist(0, 100);
+    for (std::size_t i = 0; i < to_sort.size(); ++i) {
+        to_sort[i] = {dist(gen), static_cast<int>(i)};
+    }
+
+    auto compare_keys = [](const value_type& a, const value_type& b) { return a.first < b.first; };
+
+    SECTION("in_place_merge_sort") {
+        alg::in_place_merge_sort(to_sort.begin(), to_sort.end(), compare_keys);
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("in_place_merge_sort - default compare") {
+        alg::in_place_merge_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("merge_sort_buf - empty buffer") {
+        alg::merge_sort_buf(to_sort.begin(), to_sort.end(), static_cast<value_type*>(nullptr), 0, compare_keys);
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("merge_sort_buf - small buffer") {
+        std::vector<value_type> buffer(7);
+        alg::merge_sort_buf(to_sort.begin(), to_sort.end(), buffer.data(), buffer.size(), compare_keys);
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("merge_sort_buf - buffer one element short") {
+        std::vector<value_type> buffer(to_sort.size() - 1);
+        alg::merge_sort_buf(to_sort.begin(), to_sort.end(), buffer.data(), buffer.size(), compare_keys);
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("merge_sort_buf - full buffer") {
+        std::vector<value_type> buffer(to_sort.size());
+        alg::merge_sort_buf(to_sort.begin(), to_sort.end(), buffer.data(), buffer.size());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("merge_sort_buf - descending") {
+        std::vector<value_type> buffer(100);
+        alg::merge_sort_buf(to_sort.begin(), to_sort.end(), buffer.data(), 100, std::greater<value_type>());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end(), std::greater<value_type>()));
+    }
+
+    // a move of a std::string onto itself empties it, so the result is checked to be a permutation too
+    for (std::size_t size : {50, 2000}) {
+        std::vector<std::string> strings(size);
+        std::generate(strings.begin(), strings.end(), [&]() { return std::to_string(dist(gen) * 1000003); });
+        auto expected = strings;
+        std::sort(expected.begin(), expected.end());
+
+        SECTION("in_place_merge_sort - strings, size = " + std::to_string(size)) {
+            alg::in_place_merge_sort(strings.begin(), strings.end());
+            REQUIRE(strings == expected);
+        }
+        for (std::size_t buffer_size : {0, 1, 7}) {
+            SECTION("merge_sort_buf - strings, size = " + std::to_string(size) +
+                    ", buffer size = " + std::to_string(buffer_size)) {
+                std::vector<std::string> buffer(buffer_size);
+                alg::merge_sort_buf(
+                    strings.begin(), strings.end(), buffer.data(), buffer.size(), std::less<std::string>());
+                REQUIRE(strings == expected);
+            }
+        }
+    }
+}
+
+// counts its live instances, to check that the buffers of the algorithms are destroyed
+struct Counted {
+    static int alive;
+
+    int value;
+
+    Counted(int value = 0) : value(value) { ++alive; }
+    Counted(const Counted& other) : value(other.value) { ++alive; }
+    Counted& operator=(const Counted&) = default;
+    ~Counted() { --alive; }
+
+    bool operator<(const Counted& other) const { return value < other.value; }
+};
+
+int Counted::alive = 0;
+
+TEST_CASE("sort_context") {
+    alg::sort_context context;
+    std::uniform_int_distribution<> dist(0, 1000);
+
+    SECTION("repeated sorts do not allocate") {
+        std::vector<int> batch(1000);
+        std::size_t allocations_after_first_round = 0;
+        for (int round = 0; round < 20; ++round) {
+            std::generate(batch.begin(), batch.end(), [&]() { return dist(gen); });
+            batch[0] = 0;  // every batch needs the same number of counters in counting_sort
+            batch[1] = 1000;
+            auto expected = batch;
+            std::sort(expected.begin(), expected.end());
+
+            auto tmp = batch;
+            alg::merge_sort(context, tmp.begin(), tmp.end());
+            REQUIRE(tmp == expected);
+
+            tmp = batch;
+            alg::in_place_merge_sort(context, tmp.begin(), tmp.end(), std::less<int>());
+            REQUIRE(tmp == expected);
+
+            tmp = batch;
+            alg::radix_sort(context, tmp.begin(), tmp.end());
+            REQUIRE(tmp == expected);
+
+            tmp = batch;
+            alg::counting_sort(context, tmp.begin(), tmp.end());
+            REQUIRE(tmp == expected);
+
+            if (round == 0) {
+                allocations_after_first_round = context.allocation_count();
+            }
+        }
+        REQUIRE(allocations_after_first_round > 0);
+        REQUIRE(context.allocation_count() == allocations_after_first_round);
+        REQUIRE(context.capacity() >= 1000 * sizeof(int));
+
+        context.release();
+        REQUIRE(context.capacity() == 0);
+    }
+
+    SECTION("the other buffered algorithms do not allocate either") {
+        std::size_t allocations_after_first_round = 0;
+        for (int round = 0; round < 10; ++round) {
+            // the first batch is the largest, since the buffer of tim_sort grows with the longest merge
+            std::vector<int> batch(round == 0 ? 2000 : 1000);
+            std::generate(batch.begin(), batch.end(), [&]() { return dist(gen); });
+            auto expected = batch;
+            std::sort(expected.begin(), expected.end());
+
+            auto tmp = batch;
+            alg::tim_sort(context, tmp.begin(), tmp.end());
+            REQUIRE(tmp == expected);
+
+            tmp = batch;
+            alg::sort_by_key(context, tmp.begin(), tmp.end(), [](int x) { return x; });
+            REQUIRE(tmp == expected);
+
+            tmp = batch;
+            alg::stable_sort_by_key(context, tmp.begin(), tmp.end(), [](int x) { return -x; }, std::greater<int>());
+            REQUIRE(tmp == expected);
+
+            tmp = batch;
+            std::vector<std::string> payload(tmp.size());
+            std::transform(tmp.begin(), tmp.end(), payload.begin(), [](int x) { return std::to_string(x); });
+            alg::co_sort(context, tmp.begin(), tmp.end(), payload.begin());
+            REQUIRE(tmp == expected);
+            for (std::size_t i = 0; i < tmp.size(); ++i) {
+                REQUIRE(payload[i] == std::to_string(tmp[i]));
+            }
+
+            std::vector<std::string> strings(payload.rbegin(), payload.rend());
+            auto expected_strings = strings;
+            std::sort(expected_strings.begin(), expected_strings.end());
+            alg::string_sort(context, strings.begin(), strings.end());
+            REQUIRE(strings == expected_strings);
+
+            if (round == 0) {
+                allocations_after_first_round = context.allocation_count();
+            }
+        }
+        REQUIRE(context.allocation_count() == allocations_after_first_round);
+    }
+
+    SECTION("parallel sorts do not allocate their buffers either") {
+        const alg::parallel_policy policy(2);
+        std::size_t allocations_after_first_round = 0;
+        for (int round = 0; round < 3; ++round) {
+            std::vector<int> batch(40000);
+            std::generate(batch.begin(), batch.end(), [&]() { return dist(gen); });
+            auto expected = batch;
+            std::sort(expected.begin(), expected.end());
+
+            auto tmp = batch;
+            alg::merge_sort(policy, context, tmp.begin(), tmp.end());
+            REQUIRE(tmp == expected);
+
+            tmp = batch;
+            alg::radix_sort(policy, context, tmp.begin(), tmp.end());
+            REQUIRE(tmp == expected);
+
+            if (round == 0) {
+                allocations_after_first_round = context.allocation_count();
+            }
+        }
+        REQUIRE(context.allocation_count() == allocations_after_first_round);
+    }
+
+    SECTION("growing batches") {
+        for (std::size_t size = 1; size <= 4096; size *= 2) {
+            std::vector<int> batch(size);
+            std::generate(batch.begin(), batch.end(), [&]() { return dist(gen); });
+            alg::merge_sort(context, batch.begin(), batch.end(), std::greater<int>());
+            REQUIRE(std::is_sorted(batch.begin(), batch.end(), std::greater<int>()));
+        }
+        REQUIRE(context.allocation_count() <= 13);
+    }
+
+    SECTION("non-trivial elements are constructed and destroyed") {
+        {
+            std::vector<Counted> vec(500);
+            std::generate(vec.begin(), vec.end(), [&]() { return Counted(dist(gen)); });
+
+            auto tmp = vec;
+            alg::merge_sort(context, tmp.begin(), tmp.end());
+            REQUIRE(std::is_sorted(tmp.begin(), tmp.end()));
+            REQUIRE(Counted::alive == 1000);
+
+            tmp = vec;
+            alg::merge_sort(tmp.begin(), tmp.end());
+            REQUIRE(std::is_sorted(tmp.begin(), tmp.end()));
+            REQUIRE(Counted::alive == 1000);
+
+            tmp = vec;
+            alg::tim_sort(context, tmp.begin(), tmp.end());
+            REQUIRE(std::is_sorted(tmp.begin(), tmp.end()));
+            REQUIRE(Counted::alive == 1000);
+
+            std::vector<std::string> strings(300);
+            std::generate(strings.begin(), strings.end(),
+                          [&]() { return std::string(40, 'a') + std::to_string(dist(gen)); });
+            auto expected = strings;
+            std::stable_sort(expected.begin(), expected.end());
+            alg::merge_sort(context, strings.begin(), strings.end());
+            REQUIRE(strings == expected);
+        }
+        REQUIRE(Counted::alive == 0);
+    }
+
+    SECTION("merge_sort with an lvalue comparator") {
+        std::vector<int> vec(100);
+        std::generate(vec.begin(), vec.end(), [&]() { return dist(gen); });
+        auto descending = [](int a, int b) { return a > b; };
+        alg::merge_sort(vec.begin(), vec.end(), descending);
+        REQUIRE(std::is_sorted(vec.begin(), vec.end(), descending));
+
+        std::allocator<int> allocator;
+        alg::merge_sort(vec.begin(), vec.end(), allocator);
+        REQUIRE(std::is_sorted(vec.begin(), vec.end()));
+    }
+}
+
+TEST_CASE("multiway_merge") {
+    using element = std::pair<int, int>;  // (key, index of the range)
+    using range   = std::pair<std::vector<element>::iterator, std::vector<element>::iterator>;
+
+    auto compare_keys = [](const element& a, const element& b) { return a.first < b.first; };
+
+    for (std::size_t k : {1, 2, 3, 7, 16, 33}) {
+        std::vector<std::vector<element>> inputs(k);
+        std::vector<element> all;
+
+        std::uniform_int_distribution<> dist(0, 100);
+        std::uniform_int_distribution<std::size_t> size_dist(0, 5000);
+        for (std::size_t i = 0; i < k; ++i) {
+            inputs[i].resize(size_dist(gen));
+            std::generate(inputs[i].begin(), inputs[i].end(), [&]() { return element(dist(gen), i); });
+            std::sort(inputs[i].begin(), inputs[i].end(), compare_keys);
+            all.insert(all.end(), inputs[i].begin(), inputs[i].end());
+        }
+        std::stable_sort(all.begin(), all.end(), compare_keys);
+
+        std::vector<range> ranges;
+        for (auto& input : inputs) {
+            ranges.push_back({input.begin(), input.end()});
+        }
+        std::vector<element> merged(all.size());
+
+        SECTION("k = " + std::to_string(k)) {
+            auto last = alg::multiway_merge(ranges.begin(), ranges.end(), merged.begin(), compare_keys);
+            REQUIRE(last == merged.end());
+            REQUIRE(std::is_sorted(merged.begin(), merged.end(), compare_keys));
+            std::sort(merged.begin(), merged.end());
+            std::sort(all.begin(), all.end());
+            REQUIRE(merged == all);
+        }
+        SECTION("stable, k = " + std::to_string(k)) {
+            auto last = alg::stable_multiway_merge(ranges.begin(), ranges.end(), merged.begin(), compare_keys);
+            REQUIRE(last == merged.end());
+            REQUIRE(merged == all);
+        }
+        SECTION("parallel, k = " + std::to_string(k)) {
+            auto last = alg::multiway_merge(alg::parallel_policy(4), ranges.begin(), ranges.end(), merged.begin(),
+                                            compare_keys);
+            REQUIRE(last == merged.end());
+            REQUIRE(std::is_sorted(merged.begin(), merged.end(), compare_keys));
+            std::sort(merged.begin(), merged.end());
+            std::sort(all.begin(), all.end());
+            REQUIRE(merged == all);
+        }
+        SECTION("parallel stable, k = " + std::to_string(k)) {
+            auto last = alg::stable_multiway_merge(alg::parallel_policy(4), ranges.begin(), ranges.end(),
+                                                   merged.begin(), compare_keys);
+            REQUIRE(last == merged.end());
+            REQUIRE(merged == all);
+        }
+    }
+    SECTION("default compare") {
+        std::vector<int> a = {1, 4, 7}, b = {2, 5, 8}, c = {3, 6, 9};
+        std::vector<std::pair<std::vector<int>::iterator, std::vector<int>::iterator>> ranges = {
+            {a.begin(), a.end()}, {b.begin(), b.end()}, {c.begin(), c.end()}};
+        std::vector<int> merged;
+
+        alg::multiway_merge(ranges.begin(), ranges.end(), std::back_inserter(merged));
+        REQUIRE(merged == std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9});
+    }
+    SECTION("move-only elements") {
+        // the ranges have different lengths, so the shorter one runs out while the other still has elements
+        using pointer = std::unique_ptr<int>;
+        std::vector<pointer> a, b;
+        for (int i = 0; i < 10; ++i) {
+            a.emplace_back(new int(i));
+        }
+        for (int i = 0; i < 100; ++i) {
+            b.emplace_back(new int(i));
+        }
+        std::vector<std::pair<std::vector<pointer>::iterator, std::vector<pointer>::iterator>> ranges = {
+            {a.begin(), a.end()}, {b.begin(), b.end()}};
+        std::vector<pointer> merged(a.size() + b.size());
+
+        auto compare = [](const pointer& x, const pointer& y) {
+            REQUIRE(x);
+            REQUIRE(y);
+            return *x < *y;
+        };
+        alg::stable_multiway_merge(ranges.begin(), ranges.end(), merged.begin(), compare);
+        REQUIRE(std::all_of(merged.begin(), merged.end(), [](const pointer& x) { return x != nullptr; }));
+        REQUIRE(std::is_sorted(merged.begin(), merged.end(), compare));
+    }
+    SECTION("merge of two ranges") {
+        std::vector<int> a = {1, 3, 5}, b = {2, 4, 6}, merged(6);
+        REQUIRE(alg::merge(a.begin(), a.end(), b.begin(), b.end(), merged.begin()) == merged.end());
+        REQUIRE(merged == std::vector<int>{1, 2, 3, 4, 5, 6});
+    }
+}
+
+TEST_CASE("parallel sorting functions") {
+    // large enough to be split into several tasks
+    std::vector<std::pair<int, int>> to_sort(200000);
+
+    std::uniform_int_distribution<> dist(0, 1000);
+    for (std::size_t i = 0; i < to_sort.size(); ++i) {
+        to_sort[i] = {dist(gen), static_cast<int>(i)};
+    }
+
+    auto compare_keys = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; };
+
+    SECTION("merge_sort") {
+        SECTION("stable") {
+            alg::merge_sort(alg::parallel_policy(4), to_sort.begin(), to_sort.end(), compare_keys);
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+        SECTION("single thread") {
+            alg::merge_sort(alg::parallel_policy(1), to_sort.begin(), to_sort.end(), compare_keys);
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+        SECTION("default compare") {
+            alg::merge_sort(alg::parallel_policy(3), to_sort.begin(), to_sort.end());
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+    }
+    SECTION("quick_sort") {
+        SECTION("default compare") {
+            alg::quick_sort(alg::parallel_policy(4), to_sort.begin(), to_sort.end());
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+        SECTION("descending") {
+            alg::quick_sort(alg::parallel_policy(4), to_sort.begin(), to_sort.end(), std::greater<std::pair<int, int>>());
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end(), std::greater<std::pair<int, int>>()));
+        }
+        SECTION("sorted") {
+            std::sort(to_sort.begin(), to_sort.end());
+            alg::quick_sort(alg::parallel_policy(2), to_sort.begin(), to_sort.end());
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+    }
+    SECTION("radix_sort") {
+        std::vector<std::int64_t> keys(to_sort.size());
+        std::uniform_int_distribution<std::int64_t> key_dist(std::numeric_limits<std::int64_t>::min(),
+                                                             std::numeric_limits<std::int64_t>::max());
+        std::generate(keys.begin(), keys.end(), [&key_dist]() { return key_dist(gen); });
+
+        auto expected = keys;
+        std::sort(expected.begin(), expected.end());
+
+        alg::radix_sort(alg::parallel_policy(4), keys.begin(), keys.end());
+        REQUIRE(keys == expected);
+    }
+}
+
+template <class T>
+static void check_sorting_networks() {
+    std::uniform_int_distribution<> dist(-100, 100);
+
+    for (std::size_t n = 0; n <= alg::detail::SORTING_NETWORK_SIZE; ++n) {
+        std::vector<T> to_sort(n);
+        std::generate(to_sort.begin(), to_sort.end(), [&dist]() { return static_cast<T>(dist(gen)); });
+
+        auto expected = to_sort;
+        std::sort(expected.begin(), expected.end());
+
+        // checks every instruction set supported by the CPU, not only the best one
+        auto best_level = static_cast<int>(alg::detail::simd_level());
+        for (auto i = static_cast<int>(alg::detail::SimdLevel::sse4); i <= best_level; ++i) {
+            auto level = static_cast<alg::detail::SimdLevel>(i);
+
+            auto ascending = to_sort;
+            REQUIRE(alg::detail::sorting_network_sort(ascending.begin(), ascending.end(), std::less<T>(), level));
+            REQUIRE(ascending == expected);
+
+            auto descending = to_sort;
+            REQUIRE(alg::detail::sorting_network_sort(descending.begin(), descending.end(), std::greater<T>(), level));
+            REQUIRE(std::equal(descending.rbegin(), descending.rend(), expected.begin()));
+        }
+
+        // goes through the sorting network of the best instruction set, or the insertion sort fallback
+        alg::quick_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(to_sort == expected);
+    }
+}
+
+TEST_CASE("sorting networks") {
+    SECTION("int32_t") { check_sorting_networks<int32_t>(); }
+    SECTION("int64_t") { check_sorting_networks<int64_t>(); }
+    SECTION("float") { check_sorting_networks<float>(); }
+    SECTION("double") { check_sorting_networks<double>(); }
+    SECTION("signed zeros and NaNs are preserved") {
+        std::vector<double> to_sort = {0.0, -0.0, 1.0, -0.0, 0.0, -1.0};
+        alg::quick_sort(to_sort.begin(), to_sort.end());
+        auto negative_zeros =
+            std::count_if(to_sort.begin(), to_sort.end(), [](double d) { return d == 0.0 && std::signbit(d); });
+        REQUIRE(negative_zeros == 2);
+
+        std::vector<double> with_nan = {3.0, std::numeric_limits<double>::quiet_NaN(), 1.0, 2.0};
+        alg::quick_sort(with_nan.begin(), with_nan.end());
+        REQUIRE(std::count_if(with_nan.begin(), with_nan.end(), [](double d) { return d != d; }) == 1);
+    }
+    SECTION("merge_sort leaves") {
+        std::vector<int64_t> to_sort(1000);
+        std::uniform_int_distribution<int64_t> dist;
+        std::generate(to_sort.begin(), to_sort.end(), [&dist]() { return dist(gen); });
+        alg::merge_sort(to_sort.begin(), to_sort.end(), std::greater<int64_t>());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end(), std::greater<int64_t>()));
+    }
+}
+
 TEST_CASE("radix_sort & counting_sort") {
     std::vector<unsigned> to_sort(500);
 
@@ -102,45 +770,871 @@ TEST_CASE("radix_sort & counting_sort") {
         REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
     }
     SECTION("radix_sort") {
-        alg::radix_sort(to_sort.begin(), to_sort.end(), MAX_ELEMENT);
-        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        SECTION("with max") {
+            alg::radix_sort(to_sort.begin(), to_sort.end(), MAX_ELEMENT);
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+        SECTION("without max") {
+            alg::radix_sort(to_sort.begin(), to_sort.end());
+            REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+        }
+        SECTION("bidirectional iterator") {
+            std::list<unsigned> list(to_sort.begin(), to_sort.end());
+            alg::radix_sort(list.begin(), list.end());
+            REQUIRE(std::is_sorted(list.begin(), list.end()));
+        }
     }
 }
 
-TEST_CASE("bucket_sort") {
-    std::vector<double> to_sort(500);
+TEST_CASE("counting_sort without max") {
+    auto check = [](std::vector<std::int64_t> vec) {
+        auto expected = vec;
+        std::sort(expected.begin(), expected.end());
+        alg::counting_sort(vec.begin(), vec.end());
+        REQUIRE(vec == expected);
+    };
 
-    std::uniform_real_distribution<> dist;
-    std::generate(to_sort.begin(), to_sort.end(), [&dist]() { return dist(gen); });
+    for (std::size_t size : {0, 1, 2, 100, 10000}) {
+        SECTION("negative values, size = " + std::to_string(size)) {
+            std::uniform_int_distribution<std::int64_t> dist(-500, 500);
+            std::vector<std::int64_t> vec(size);
+            std::generate(vec.begin(), vec.end(), [&]() { return dist(gen); });
+            check(vec);
+        }
+        SECTION("values clustered far from zero, size = " + std::to_string(size)) {
+            std::uniform_int_distribution<std::int64_t> dist(1000000000000, 1000000000300);
+            std::vector<std::int64_t> vec(size);
+            std::generate(vec.begin(), vec.end(), [&]() { return dist(gen); });
+            check(vec);
+        }
+        SECTION("full range (radix sort), size = " + std::to_string(size)) {
+            std::uniform_int_distribution<std::int64_t> dist(std::numeric_limits<std::int64_t>::min(),
+                                                             std::numeric_limits<std::int64_t>::max());
+            std::vector<std::int64_t> vec(size);
+            std::generate(vec.begin(), vec.end(), [&]() { return dist(gen); });
+            if (size > 0) {
+                vec.front() = std::numeric_limits<std::int64_t>::min();
+                vec.back()  = std::numeric_limits<std::int64_t>::max();
+            }
+            check(vec);
+        }
+    }
 
-    SECTION("random access iterator") {
-        alg::bucket_sort(to_sort.begin(), to_sort.end());
-        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    SECTION("small types over their whole range") {
+        std::vector<signed char> chars(1000);
+        std::uniform_int_distribution<int> dist(-128, 127);
+        std::generate(chars.begin(), chars.end(), [&]() { return static_cast<signed char>(dist(gen)); });
+        chars[0] = -128;
+        chars[1] = 127;
+        alg::counting_sort(chars.begin(), chars.end());
+        REQUIRE(std::is_sorted(chars.begin(), chars.end()));
+
+        std::vector<std::uint64_t> wide = {std::numeric_limits<std::uint64_t>::max(), 0, 5, 5, 1};
+        alg::counting_sort(wide.begin(), wide.end());
+        REQUIRE(wide == std::vector<std::uint64_t>{0, 1, 5, 5, std::numeric_limits<std::uint64_t>::max()});
     }
-    SECTION("bidirectional iterator") {
-        std::list<double> list(to_sort.begin(), to_sort.end());
-        alg::bucket_sort(list.begin(), list.end(), list.size());
+
+    SECTION("forward iterator") {
+        std::forward_list<int> list = {3, -1, 2, -1, 0, 7};
+        alg::counting_sort(list.begin(), list.end());
         REQUIRE(std::is_sorted(list.begin(), list.end()));
     }
-    SECTION("forward iterator") {
-        std::forward_list<double> forward_list(to_sort.begin(), to_sort.end());
-        alg::bucket_sort(forward_list.begin(), forward_list.end(), to_sort.size());
-        REQUIRE(std::is_sorted(forward_list.begin(), forward_list.end()));
+
+    SECTION("with a sort_context") {
+        alg::sort_context context;
+        std::uniform_int_distribution<int> narrow(-100, 100), wide;
+        std::vector<int> vec(5000);
+        std::generate(vec.begin(), vec.end(), [&]() { return narrow(gen); });
+        alg::counting_sort(context, vec.begin(), vec.end());
+        REQUIRE(std::is_sorted(vec.begin(), vec.end()));
+
+        std::generate(vec.begin(), vec.end(), [&]() { return wide(gen); });
+        alg::counting_sort(context, vec.begin(), vec.end());
+        REQUIRE(std::is_sorted(vec.begin(), vec.end()));
     }
 }
 
-TEST_CASE("quick_select") {
-    std::vector<int> sample_array(500);
+TEST_CASE("radix_sort of signed and wide integers") {
+    SECTION("int") {
+        std::vector<int> to_sort(500);
+        std::uniform_int_distribution<int> dist(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+        std::generate(to_sort.begin(), to_sort.end(), [&dist]() { return dist(gen); });
 
-    std::uniform_int_distribution<> dist;
-    std::generate(sample_array.begin(), sample_array.end(), [&dist]() { return dist(gen); });
+        alg::radix_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("int64_t") {
+        std::vector<std::int64_t> to_sort(500);
+        std::uniform_int_distribution<std::int64_t> dist(std::numeric_limits<std::int64_t>::min(),
+                                                         std::numeric_limits<std::int64_t>::max());
+        std::generate(to_sort.begin(), to_sort.end(), [&dist]() { return dist(gen); });
 
-    auto sorted = sample_array;
-    std::sort(sorted.begin(), sorted.end());
+        alg::radix_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("signed char") {
+        std::vector<signed char> to_sort(500);
+        std::uniform_int_distribution<int> dist(-128, 127);
+        std::generate(to_sort.begin(), to_sort.end(), [&dist]() { return static_cast<signed char>(dist(gen)); });
 
-    for (std::size_t i = 0; i < sample_array.size(); ++i) {
-        auto current_pos = sample_array.begin() + i;
-        alg::quick_select(sample_array.begin(), current_pos, sample_array.end());
+        alg::radix_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("uint16_t") {
+        std::vector<std::uint16_t> to_sort(500);
+        std::uniform_int_distribution<int> dist(0, 65535);
+        std::generate(to_sort.begin(), to_sort.end(), [&dist]() { return static_cast<std::uint16_t>(dist(gen)); });
+
+        alg::radix_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+}
+
+// the order alg::radix_sort gives to floating-point values: -0.0 before +0.0 and the NaNs last
+template <class Float>
+static bool radix_order(Float a, Float b) {
+    if (std::isnan(a) || std::isnan(b)) {
+        return !std::isnan(a);
+    }
+    if (a == b) {
+        return std::signbit(a) && !std::signbit(b);
+    }
+    return a < b;
+}
+
+// random bit patterns, which cover every exponent, the subnormals and the NaNs, plus the special values
+template <class Float, class Bits>
+static std::vector<Float> random_floats(std::size_t size) {
+    std::uniform_int_distribution<Bits> dist;
+    std::vector<Float> values(size);
+    for (auto& value : values) {
+        auto bits = dist(gen);
+        std::memcpy(&value, &bits, sizeof(value));
+    }
+
+    const Float special[] = {Float(0.0),
+                             -Float(0.0),
+                             std::numeric_limits<Float>::infinity(),
+                             -std::numeric_limits<Float>::infinity(),
+                             std::numeric_limits<Float>::quiet_NaN(),
+                             -std::numeric_limits<Float>::quiet_NaN(),
+                             std::numeric_limits<Float>::denorm_min(),
+                             -std::numeric_limits<Float>::denorm_min(),
+                             std::numeric_limits<Float>::max(),
+                             std::numeric_limits<Float>::lowest()};
+    std::uniform_int_distribution<std::size_t> position(0, size - 1);
+    for (auto value : special) {
+        for (int i = 0; i < 10; ++i) {
+            values[position(gen)] = value;
+        }
+    }
+    return values;
+}
+
+// compares the bits, since NaNs and the signed zeros can not be told apart by ==
+template <class Container, class Float>
+static bool same_bits(const Container& a, const std::vector<Float>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](Float x, Float y) {
+               return std::memcmp(&x, &y, sizeof(Float)) == 0;
+           });
+}
+
+template <class Float, class Bits>
+static void test_float_radix_sort() {
+    auto to_sort  = random_floats<Float, Bits>(5000);
+    auto expected = to_sort;
+    std::stable_sort(expected.begin(), expected.end(), radix_order<Float>);
+
+    SECTION("radix_sort") {
+        alg::radix_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(same_bits(to_sort, expected));
+    }
+    SECTION("radix_sort of a list") {
+        std::list<Float> list(to_sort.begin(), to_sort.end());
+        alg::radix_sort(list.begin(), list.end());
+        REQUIRE(same_bits(list, expected));
+    }
+    SECTION("radix_sort with a context") {
+        alg::sort_context context;
+        alg::radix_sort(context, to_sort.begin(), to_sort.end());
+        REQUIRE(same_bits(to_sort, expected));
+    }
+    SECTION("parallel radix_sort") {
+        alg::radix_sort(alg::parallel_policy(4), to_sort.begin(), to_sort.end());
+        REQUIRE(same_bits(to_sort, expected));
+    }
+    SECTION("the NaNs are last, in their original order") {
+        auto nan_count = std::count_if(to_sort.begin(), to_sort.end(), [](Float x) { return std::isnan(x); });
+        std::vector<Float> nans;
+        std::copy_if(to_sort.begin(), to_sort.end(), std::back_inserter(nans), [](Float x) { return std::isnan(x); });
+
+        alg::radix_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(std::all_of(to_sort.end() - nan_count, to_sort.end(), [](Float x) { return std::isnan(x); }));
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end() - nan_count));
+        REQUIRE(same_bits(std::vector<Float>(to_sort.end() - nan_count, to_sort.end()), nans));
+    }
+    SECTION("signed zeros") {
+        std::vector<Float> zeros  = {Float(0.0), -Float(0.0), Float(0.0), -Float(0.0), Float(-1.0), Float(1.0)};
+        std::vector<Float> sorted = {Float(-1.0), -Float(0.0), -Float(0.0), Float(0.0), Float(0.0), Float(1.0)};
+        alg::radix_sort(zeros.begin(), zeros.end());
+        REQUIRE(same_bits(zeros, sorted));
+    }
+}
+
+TEST_CASE("radix_sort of floating-point values") {
+    SECTION("float") {
+        test_float_radix_sort<float, std::uint32_t>();
+    }
+    SECTION("double") {
+        test_float_radix_sort<double, std::uint64_t>();
+    }
+    SECTION("sort_by_key with double keys") {
+        std::vector<std::pair<double, int>> to_sort(1000);
+        std::uniform_real_distribution<double> dist(-1e6, 1e6);
+        for (std::size_t i = 0; i < to_sort.size(); ++i) {
+            to_sort[i] = {dist(gen), static_cast<int>(i)};
+        }
+
+        alg::sort_by_key(to_sort.begin(), to_sort.end(), [](const std::pair<double, int>& a) { return a.first; });
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("stable sorts keep the order of signed zeros") {
+        // std::less considers -0.0 and +0.0 equivalent, so they must keep their relative order
+        std::vector<std::pair<double, int>> to_sort(100);
+        std::vector<double> keys(to_sort.size());
+        std::vector<int> ids(to_sort.size());
+        for (std::size_t i = 0; i < to_sort.size(); ++i) {
+            to_sort[i] = {i % 2 ? -0.0 : 0.0, static_cast<int>(i)};
+            keys[i]    = to_sort[i].first;
+            ids[i]     = static_cast<int>(i);
+        }
+
+        auto key = [](const std::pair<double, int>& a) { return a.first; };
+        alg::stable_sort_by_key(to_sort.begin(), to_sort.end(), key);
+        for (std::size_t i = 0; i < to_sort.size(); ++i) {
+            REQUIRE(to_sort[i].second == static_cast<int>(i));
+        }
+
+        alg::co_sort(keys.begin(), keys.end(), ids.begin());
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            REQUIRE(ids[i] == static_cast<int>(i));
+        }
+    }
+}
+
+TEST_CASE("sort_by_key") {
+    // pairs of (key, original position), the key is computed from the string
+    std::vector<std::pair<std::string, int>> to_sort(10000);
+
+    std::uniform_int_distribution<> dist(-500, 500);
+    for (std::size_t i = 0; i < to_sort.size(); ++i) {
+        to_sort[i] = {std::to_string(dist(gen)), static_cast<int>(i)};
+    }
+
+    std::size_t key_count = 0;
+    auto int_key          = [&key_count](const std::pair<std::string, int>& a) {
+        ++key_count;
+        return std::stoi(a.first);
+    };
+    auto string_key = [&key_count](const std::pair<std::string, int>& a) {
+        ++key_count;
+        return a.first;
+    };
+
+    auto compare_ints = [](const std::pair<std::string, int>& a, const std::pair<std::string, int>& b) {
+        return std::stoi(a.first) < std::stoi(b.first);
+    };
+
+    SECTION("integer keys") {
+        alg::sort_by_key(to_sort.begin(), to_sort.end(), int_key);
+        REQUIRE(key_count == to_sort.size());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end(), compare_ints));
+    }
+    SECTION("integer keys - stable") {
+        auto sorted = to_sort;
+        std::stable_sort(sorted.begin(), sorted.end(), compare_ints);
+
+        alg::stable_sort_by_key(to_sort.begin(), to_sort.end(), int_key);
+        REQUIRE(key_count == to_sort.size());
+        REQUIRE(to_sort == sorted);
+    }
+    SECTION("integer keys - descending") {
+        alg::stable_sort_by_key(to_sort.begin(), to_sort.end(), int_key, std::greater<int>());
+        REQUIRE(key_count == to_sort.size());
+        REQUIRE(std::is_sorted(to_sort.rbegin(), to_sort.rend(), compare_ints));
+    }
+    SECTION("string keys") {
+        alg::sort_by_key(to_sort.begin(), to_sort.end(), string_key);
+        REQUIRE(key_count == to_sort.size());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end(), [](const std::pair<std::string, int>& a,
+                                                                  const std::pair<std::string, int>& b) {
+            return a.first < b.first;
+        }));
+    }
+    SECTION("string keys - stable") {
+        std::reverse(to_sort.begin(), to_sort.end());
+        alg::stable_sort_by_key(to_sort.begin(), to_sort.end(), string_key);
+        REQUIRE(key_count == to_sort.size());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end(), [](const std::pair<std::string, int>& a,
+                                                                  const std::pair<std::string, int>& b) {
+            return a.first < b.first || (a.first == b.first && a.second > b.second);
+        }));
+    }
+    SECTION("short range") {
+        to_sort.resize(100);
+        auto sorted = to_sort;
+        std::stable_sort(sorted.begin(), sorted.end(), compare_ints);
+
+        alg::stable_sort_by_key(to_sort.begin(), to_sort.end(), int_key);
+        REQUIRE(to_sort == sorted);
+    }
+}
+
+struct TimSortFunction {
+    template <class RandomAccessIterator, class Compare>
+    void operator()(RandomAccessIterator first, RandomAccessIterator last, Compare compare) const {
+        alg::tim_sort(first, last, compare);
+    }
+};
+
+TEST_CASE("argsort & apply_permutation") {
+    std::vector<std::pair<int, int>> to_sort(10000);
+
+    std::uniform_int_distribution<> dist(0, 100);
+    for (std::size_t i = 0; i < to_sort.size(); ++i) {
+        to_sort[i] = {dist(gen), static_cast<int>(i)};
+    }
+
+    auto compare_keys = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; };
+
+    auto stable_sorted = to_sort;
+    std::stable_sort(stable_sorted.begin(), stable_sorted.end(), compare_keys);
+
+    SECTION("argsort") {
+        auto indices = alg::argsort(to_sort.begin(), to_sort.end(), compare_keys);
+
+        std::vector<std::pair<int, int>> sorted;
+        for (auto i : indices) {
+            sorted.push_back(to_sort[i]);
+        }
+        REQUIRE(std::is_sorted(sorted.begin(), sorted.end(), compare_keys));
+        REQUIRE(std::is_permutation(sorted.begin(), sorted.end(), to_sort.begin()));
+    }
+    SECTION("argsort - default compare") {
+        auto indices = alg::argsort(to_sort.begin(), to_sort.end());
+        alg::apply_permutation(to_sort.begin(), to_sort.end(), indices.begin());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("stable_argsort") {
+        auto indices = alg::stable_argsort(to_sort.begin(), to_sort.end(), compare_keys);
+        alg::apply_permutation(to_sort.begin(), to_sort.end(), indices.begin());
+        REQUIRE(to_sort == stable_sorted);
+    }
+    SECTION("argsort with another sorting algorithm") {
+        auto indices = alg::argsort(to_sort.begin(), to_sort.end(), compare_keys, TimSortFunction());
+        alg::apply_permutation(to_sort.begin(), to_sort.end(), indices.begin());
+        REQUIRE(to_sort == stable_sorted);
+    }
+    SECTION("apply_permutation to several ranges") {
+        std::vector<int> keys(to_sort.size());
+        std::transform(to_sort.begin(), to_sort.end(), keys.begin(), [](const std::pair<int, int>& a) {
+            return a.first;
+        });
+
+        auto indices      = alg::stable_argsort(keys.begin(), keys.end());
+        auto indices_copy = indices;
+
+        alg::apply_permutation(keys.begin(), keys.end(), indices.begin());
+        REQUIRE(indices == indices_copy);
+        alg::apply_permutation(to_sort.begin(), to_sort.end(), indices.begin());
+        REQUIRE(indices == indices_copy);
+
+        REQUIRE(std::is_sorted(keys.begin(), keys.end()));
+        REQUIRE(to_sort == stable_sorted);
+    }
+    SECTION("apply_permutation - signed indices") {
+        std::vector<int> values  = {10, 11, 12, 13, 14, 15};
+        std::vector<int> indices = {3, 0, 1, 2, 5, 4};
+
+        alg::apply_permutation(values.begin(), values.end(), indices.begin());
+        REQUIRE(values == std::vector<int>{13, 10, 11, 12, 15, 14});
+        REQUIRE(indices == std::vector<int>{3, 0, 1, 2, 5, 4});
+    }
+
+    // the complement of a uint16_t index is below n once n > 32768, so those are marked in a bit vector
+    for (std::size_t size : {30000, 32768, 32769, 40000, 65535}) {
+        SECTION("apply_permutation - uint16_t indices, size = " + std::to_string(size)) {
+            std::vector<std::uint16_t> indices(size);
+            std::iota(indices.begin(), indices.end(), std::uint16_t(0));
+            std::shuffle(indices.begin(), indices.end(), gen);
+            auto indices_copy = indices;
+
+            std::vector<std::size_t> values(size);
+            std::iota(values.begin(), values.end(), std::size_t(0));
+            alg::apply_permutation(values.begin(), values.end(), indices.begin());
+
+            REQUIRE(std::equal(values.begin(), values.end(), indices.begin()));
+            REQUIRE(indices == indices_copy);
+        }
+    }
+}
+
+TEST_CASE("co_sort") {
+    std::vector<uint64_t> keys(10000);
+    std::vector<std::string> names(keys.size());
+    std::vector<double> values(keys.size());
+
+    std::uniform_int_distribution<uint64_t> dist(0, 1000);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        keys[i]   = dist(gen);
+        names[i]  = std::to_string(keys[i]);
+        values[i] = static_cast<double>(i);
+    }
+
+    // the positions of the rows after a stable sort by key
+    auto indices = alg::stable_argsort(keys.begin(), keys.end());
+
+    auto check_columns = [&]() {
+        REQUIRE(std::is_sorted(keys.begin(), keys.end()));
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            REQUIRE(names[i] == std::to_string(keys[i]));
+            REQUIRE(values[i] == static_cast<double>(indices[i]));
+        }
+    };
+
+    SECTION("default backend") {
+        alg::co_sort(keys.begin(), keys.end(), names.begin(), values.begin());
+        check_columns();
+    }
+    SECTION("radix backend") {
+        alg::co_sort(alg::CoSortMode::Radix(), keys.begin(), keys.end(), names.begin(), values.begin());
+        check_columns();
+    }
+    SECTION("merge backend") {
+        alg::co_sort(alg::CoSortMode::Merge(), keys.begin(), keys.end(), names.begin(), values.begin());
+        check_columns();
+    }
+    SECTION("string keys") {
+        alg::co_sort(names.begin(), names.end(), keys.begin());
+        REQUIRE(std::is_sorted(names.begin(), names.end()));
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            REQUIRE(names[i] == std::to_string(keys[i]));
+        }
+    }
+    SECTION("no payload columns") {
+        alg::co_sort(keys.begin(), keys.end());
+        REQUIRE(std::is_sorted(keys.begin(), keys.end()));
+    }
+}
+
+TEST_CASE("bucket_sort") {
+    std::vector<double> to_sort(500);
+
+    std::uniform_real_distribution<> dist;
+    std::generate(to_sort.begin(), to_sort.end(), [&dist]() { return dist(gen); });
+
+    SECTION("random access iterator") {
+        alg::bucket_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("bidirectional iterator") {
+        std::list<double> list(to_sort.begin(), to_sort.end());
+        alg::bucket_sort(list.begin(), list.end(), list.size());
+        REQUIRE(std::is_sorted(list.begin(), list.end()));
+    }
+    SECTION("forward iterator") {
+        std::forward_list<double> forward_list(to_sort.begin(), to_sort.end());
+        alg::bucket_sort(forward_list.begin(), forward_list.end(), to_sort.size());
+        REQUIRE(std::is_sorted(forward_list.begin(), forward_list.end()));
+    }
+
+    auto check = [](std::vector<double> vec) {
+        auto expected = vec;
+        std::sort(expected.begin(), expected.end());
+        alg::bucket_sort(vec.begin(), vec.end());
+        REQUIRE(vec == expected);
+    };
+
+    for (std::size_t size : {0, 1, 2, 16, 17, 100, 10000, 100000}) {
+        SECTION("arbitrary ranges, size = " + std::to_string(size)) {
+            std::vector<double> vec(size);
+
+            std::uniform_real_distribution<> wide(-1e12, 1e12);
+            std::generate(vec.begin(), vec.end(), [&]() { return wide(gen); });
+            check(vec);
+
+            // skewed, most of the values are in a few buckets of the first level
+            std::exponential_distribution<> exponential(3.0);
+            std::generate(vec.begin(), vec.end(), [&]() { return exponential(gen); });
+            check(vec);
+
+            std::lognormal_distribution<> lognormal(0.0, 4.0);
+            std::generate(vec.begin(), vec.end(), [&]() { return lognormal(gen); });
+            check(vec);
+
+            std::uniform_int_distribution<> few_values(-3, 3);
+            std::generate(vec.begin(), vec.end(), [&]() { return few_values(gen) * 0.5; });
+            check(vec);
+
+            std::fill(vec.begin(), vec.end(), 42.0);
+            check(vec);
+        }
+    }
+
+    SECTION("extreme values") {
+        check({std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(), 0.0, 1.0, -1.0,
+               std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::infinity(),
+               -std::numeric_limits<double>::infinity(), 1e-300, -1e-300, 3.0, 2.0, 5.0, 8.0, 13.0, 21.0, 34.0,
+               55.0, 89.0});
+
+        std::vector<double> tiny(1000);
+        std::uniform_int_distribution<> dist(0, 100);
+        std::generate(tiny.begin(), tiny.end(),
+                      [&]() { return dist(gen) * std::numeric_limits<double>::denorm_min(); });
+        check(tiny);
+    }
+
+    SECTION("float and a sort_context") {
+        alg::sort_context context;
+        std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+        for (std::size_t size : {10, 1000, 5000}) {
+            std::vector<float> vec(size);
+            std::generate(vec.begin(), vec.end(), [&]() { return dist(gen); });
+            auto expected = vec;
+            std::sort(expected.begin(), expected.end());
+            alg::bucket_sort(context, vec.begin(), vec.end());
+            REQUIRE(vec == expected);
+        }
+    }
+
+    SECTION("skewed data and a sort_context") {
+        alg::sort_context context;
+        std::lognormal_distribution<> lognormal(0.0, 4.0);
+        std::vector<double> skewed(20000);
+        std::generate(skewed.begin(), skewed.end(), [&]() { return lognormal(gen); });
+        auto expected = skewed;
+        std::sort(expected.begin(), expected.end());
+
+        std::size_t allocations_after_first_sort = 0;
+        for (int round = 0; round < 3; ++round) {
+            auto vec = skewed;
+            alg::bucket_sort(context, vec.begin(), vec.end());
+            REQUIRE(vec == expected);
+            if (round == 0) {
+                allocations_after_first_sort = context.allocation_count();
+            }
+        }
+        // the scratch buffer and the top-level offsets take one allocation each, the rest is re-bucketing
+        REQUIRE(allocations_after_first_sort > 2);
+        REQUIRE(context.allocation_count() == allocations_after_first_sort);
+    }
+}
+
+TEST_CASE("string_sort") {
+    std::vector<std::string> to_sort(2000);
+
+    std::uniform_int_distribution<std::size_t> length_dist(0, 20);
+    std::uniform_int_distribution<int> char_dist('a', 'd');
+    auto random_string = [&]() {
+        std::string str(length_dist(gen), '\0');
+        std::generate(str.begin(), str.end(), [&char_dist]() { return static_cast<char>(char_dist(gen)); });
+        return str;
+    };
+
+    SECTION("random strings") {
+        std::generate(to_sort.begin(), to_sort.end(), random_string);
+        auto expected = to_sort;
+        std::sort(expected.begin(), expected.end());
+
+        alg::string_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(to_sort == expected);
+    }
+    SECTION("long shared prefixes") {
+        const std::string prefixes[] = {"https://example.com/api/v1/", "https://example.com/api/v2/", ""};
+        std::uniform_int_distribution<int> prefix_dist(0, 2);
+        std::generate(to_sort.begin(), to_sort.end(), [&]() { return prefixes[prefix_dist(gen)] + random_string(); });
+        auto expected = to_sort;
+        std::sort(expected.begin(), expected.end());
+
+        alg::string_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(to_sort == expected);
+    }
+    SECTION("non-ascii characters") {
+        std::generate(to_sort.begin(), to_sort.end(), [&]() { return random_string() + "\xff" + random_string(); });
+        auto expected = to_sort;
+        std::sort(expected.begin(), expected.end());
+
+        alg::string_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(to_sort == expected);
+    }
+}
+
+TEST_CASE("sort & stable_sort") {
+    alg::sort_diagnostics diagnostics;
+
+    SECTION("the chosen algorithms") {
+        std::vector<int> random(10000);
+        std::uniform_int_distribution<int> wide(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+        std::generate(random.begin(), random.end(), [&wide]() { return wide(gen); });
+
+        auto vec = random;
+        alg::sort(vec.begin(), vec.end(), diagnostics);
+        REQUIRE(std::is_sorted(vec.begin(), vec.end()));
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::radix_sort);
+        REQUIRE(diagnostics.size == vec.size());
+        REQUIRE(diagnostics.sample_size == alg::detail::SORT_SAMPLE_SIZE);
+        REQUIRE(!diagnostics.buffered);
+
+        alg::sort(vec.begin(), vec.end(), diagnostics);
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::tim_sort);
+        REQUIRE(diagnostics.ascending_ratio == 1.0);
+
+        std::reverse(vec.begin(), vec.end());
+        alg::sort(vec.begin(), vec.end(), diagnostics);
+        REQUIRE(std::is_sorted(vec.begin(), vec.end()));
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::tim_sort);
+
+        std::uniform_int_distribution<int> narrow(-100, 100);
+        std::generate(vec.begin(), vec.end(), [&narrow]() { return narrow(gen); });
+        alg::sort(vec.begin(), vec.end(), diagnostics);
+        REQUIRE(std::is_sorted(vec.begin(), vec.end()));
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::counting_sort);
+        REQUIRE(diagnostics.key_range <= 200);
+
+        // few distinct values, far apart
+        std::generate(vec.begin(), vec.end(), [&narrow]() { return narrow(gen) % 4 * 100000000; });
+        alg::sort(vec.begin(), vec.end(), diagnostics);
+        REQUIRE(std::is_sorted(vec.begin(), vec.end()));
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::pattern_defeating_quick_sort);
+        REQUIRE(diagnostics.duplicate_ratio >= alg::detail::SORT_DUPLICATE_RATIO);
+
+        vec = random;
+        alg::sort(vec.begin(), vec.end(), std::greater<int>(), diagnostics);
+        REQUIRE(std::is_sorted(vec.rbegin(), vec.rend()));
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::pattern_defeating_quick_sort);
+        REQUIRE(diagnostics.key_range == 0);
+
+        vec = random;
+        alg::stable_sort(vec.begin(), vec.end(), std::greater<int>(), diagnostics);
+        REQUIRE(std::is_sorted(vec.rbegin(), vec.rend()));
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::merge_sort);
+
+        std::vector<std::int64_t> wide_ints(random.begin(), random.end());
+        alg::sort(wide_ints.begin(), wide_ints.end(), diagnostics);
+        REQUIRE(std::is_sorted(wide_ints.begin(), wide_ints.end()));
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::pattern_defeating_quick_sort);
+
+        wide_ints.assign(random.begin(), random.end());
+        alg::stable_sort(wide_ints.begin(), wide_ints.end(), diagnostics);
+        REQUIRE(std::is_sorted(wide_ints.begin(), wide_ints.end()));
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::radix_sort);
+
+        std::vector<double> doubles(random.begin(), random.end());
+        alg::stable_sort(doubles.begin(), doubles.end(), diagnostics);
+        REQUIRE(std::is_sorted(doubles.begin(), doubles.end()));
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::merge_sort);
+
+        std::vector<std::string> strings;
+        for (auto x : random) {
+            strings.push_back(std::to_string(x));
+        }
+        auto strings_copy = strings;
+        alg::stable_sort(strings.begin(), strings.end(), diagnostics);
+        REQUIRE(std::is_sorted(strings.begin(), strings.end()));
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::string_sort);
+
+        alg::sort(strings_copy.begin(), strings_copy.end(), diagnostics);
+        REQUIRE(strings_copy == strings);
+        REQUIRE(diagnostics.algorithm == alg::sort_algorithm::pattern_defeating_quick_sort);
+    }
+    SECTION("small ranges") {
+        for (std::size_t size = 0; size <= 30; ++size) {
+            std::vector<int> vec(size);
+            std::generate(vec.begin(), vec.end(), []() { return static_cast<int>(gen() % 10); });
+
+            alg::sort(vec.begin(), vec.end(), diagnostics);
+            REQUIRE(std::is_sorted(vec.begin(), vec.end()));
+            REQUIRE(diagnostics.size == size);
+            REQUIRE((size <= 24) == (diagnostics.algorithm == alg::sort_algorithm::insertion_sort));
+        }
+    }
+    SECTION("lists are sorted in a buffer") {
+        std::list<int> list(1000);
+        std::generate(list.begin(), list.end(), []() { return static_cast<int>(gen()); });
+
+        alg::sort(list.begin(), list.end(), diagnostics);
+        REQUIRE(std::is_sorted(list.begin(), list.end()));
+        REQUIRE(diagnostics.buffered);
+
+        std::forward_list<std::string> forward_list = {"c", "a", "b"};
+        alg::stable_sort(forward_list.begin(), forward_list.end());
+        REQUIRE(std::is_sorted(forward_list.begin(), forward_list.end()));
+    }
+    SECTION("stability") {
+        // (key, original position) pairs compared by key only
+        auto compare_keys = [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+            return a.first < b.first;
+        };
+
+        for (int presorted = 0; presorted < 2; ++presorted) {
+            std::vector<std::pair<int, int>> vec(5000);
+            for (std::size_t i = 0; i < vec.size(); ++i) {
+                auto key = presorted ? static_cast<int>(i / 10) : static_cast<int>(gen() % 100);
+                vec[i]   = {key, static_cast<int>(i)};
+            }
+            auto expected = vec;
+            std::stable_sort(expected.begin(), expected.end(), compare_keys);
+
+            alg::stable_sort(vec.begin(), vec.end(), compare_keys, diagnostics);
+            REQUIRE(vec == expected);
+            REQUIRE(diagnostics.algorithm ==
+                    (presorted ? alg::sort_algorithm::tim_sort : alg::sort_algorithm::merge_sort));
+        }
+    }
+    SECTION("move-only elements") {
+        std::vector<std::unique_ptr<int>> vec;
+        for (int i = 0; i < 1000; ++i) {
+            vec.emplace_back(new int(static_cast<int>(gen() % 1000)));
+        }
+        auto compare = [](const std::unique_ptr<int>& a, const std::unique_ptr<int>& b) { return *a < *b; };
+
+        alg::sort(vec.begin(), vec.end(), compare);
+        REQUIRE(std::is_sorted(vec.begin(), vec.end(), compare));
+    }
+}
+
+TEST_CASE("partition") {
+    for (std::size_t size : {1, 2, 17, 64, 65, 129, 500, 5000}) {
+        for (int max_value : {3, 1000000}) {
+            std::vector<int> to_partition(size);
+
+            std::uniform_int_distribution<> dist(0, max_value);
+            std::generate(to_partition.begin(), to_partition.end(), [&dist]() { return dist(gen); });
+
+            SECTION("random access iterator, size " + std::to_string(size) + ", max " + std::to_string(max_value)) {
+                std::uniform_int_distribution<std::size_t> pivot_dist(0, size - 1);
+                auto pivot       = to_partition.begin() + pivot_dist(gen);
+                auto pivot_value = *pivot;
+
+                pivot = alg::partition(to_partition.begin(), pivot, to_partition.end(), std::less<int>());
+
+                REQUIRE(*pivot == pivot_value);
+                REQUIRE(std::all_of(to_partition.begin(), pivot, [pivot_value](int a) { return a < pivot_value; }));
+                REQUIRE(std::none_of(pivot, to_partition.end(), [pivot_value](int a) { return a < pivot_value; }));
+            }
+        }
+    }
+    SECTION("bidirectional iterator") {
+        std::list<int> list = {5, 3, 9, 1, 5, 7, 2};
+        auto pivot          = alg::partition(list.begin(), list.begin(), list.end(), std::less<int>());
+
+        REQUIRE(*pivot == 5);
+        REQUIRE(std::all_of(list.begin(), pivot, [](int a) { return a < 5; }));
+        REQUIRE(std::none_of(pivot, list.end(), [](int a) { return a < 5; }));
+    }
+}
+
+template <class T, class Compare>
+static void check_vectorized_partition() {
+    Compare compare;
+
+    for (std::size_t size : {64, 65, 100, 1000, 10000}) {
+        for (int max_value : {3, 1000000}) {
+            std::vector<T> to_partition(size);
+
+            std::uniform_int_distribution<> dist(0, max_value);
+            std::generate(to_partition.begin(), to_partition.end(), [&dist]() { return static_cast<T>(dist(gen)); });
+
+            std::uniform_int_distribution<std::size_t> pivot_dist(0, size - 1);
+            auto pivot_value = to_partition[pivot_dist(gen)];
+
+            // goes through the kernel of the best instruction set
+            auto partitioned = to_partition;
+            auto pivot       = std::find(partitioned.begin(), partitioned.end(), pivot_value);
+            pivot            = alg::partition(partitioned.begin(), pivot, partitioned.end(), compare);
+
+            REQUIRE(*pivot == pivot_value);
+            REQUIRE(std::all_of(partitioned.begin(), pivot, [&](T a) { return compare(a, pivot_value); }));
+            REQUIRE(std::none_of(pivot, partitioned.end(), [&](T a) { return compare(a, pivot_value); }));
+            REQUIRE(std::is_permutation(partitioned.begin(), partitioned.end(), to_partition.begin()));
+
+#if SIMD_X86
+            // the AVX-512 CPUs also run the AVX2 kernel
+            if (alg::detail::simd_level() >= alg::detail::SimdLevel::avx2) {
+                constexpr bool GREATER = std::is_same<Compare, std::greater<T>>::value;
+
+                partitioned   = to_partition;
+                auto boundary = alg::detail::avx2::partition_vectorized<alg::detail::Avx2Partition<T>, GREATER>(
+                    partitioned.data(), partitioned.data() + size, pivot_value);
+
+                REQUIRE(std::all_of(partitioned.data(), boundary, [&](T a) { return compare(a, pivot_value); }));
+                REQUIRE(std::none_of(
+                    boundary, partitioned.data() + size, [&](T a) { return compare(a, pivot_value); }));
+                REQUIRE(std::is_permutation(partitioned.begin(), partitioned.end(), to_partition.begin()));
+            }
+#endif  // SIMD_X86
+        }
+    }
+}
+
+TEST_CASE("vectorized partition") {
+    SECTION("int32_t") {
+        check_vectorized_partition<int32_t, std::less<int32_t>>();
+        check_vectorized_partition<int32_t, std::greater<int32_t>>();
+    }
+    SECTION("uint32_t") {
+        check_vectorized_partition<uint32_t, std::less<uint32_t>>();
+        check_vectorized_partition<uint32_t, std::greater<uint32_t>>();
+    }
+    SECTION("int64_t") {
+        check_vectorized_partition<int64_t, std::less<int64_t>>();
+        check_vectorized_partition<int64_t, std::greater<int64_t>>();
+    }
+    SECTION("uint64_t") {
+        check_vectorized_partition<uint64_t, std::less<uint64_t>>();
+        check_vectorized_partition<uint64_t, std::greater<uint64_t>>();
+    }
+    SECTION("float") {
+        check_vectorized_partition<float, std::less<float>>();
+        check_vectorized_partition<float, std::greater<float>>();
+    }
+    SECTION("double") {
+        check_vectorized_partition<double, std::less<double>>();
+        check_vectorized_partition<double, std::greater<double>>();
+    }
+    SECTION("quick_sort of unsigned keys above the signed range") {
+        std::vector<uint64_t> to_sort(100000);
+        std::uniform_int_distribution<uint64_t> dist;
+        std::generate(to_sort.begin(), to_sort.end(), [&dist]() { return dist(gen); });
+        alg::quick_sort(to_sort.begin(), to_sort.end());
+        REQUIRE(std::is_sorted(to_sort.begin(), to_sort.end()));
+    }
+    SECTION("quick_select") {
+        std::vector<float> to_select(100000);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::generate(to_select.begin(), to_select.end(), [&dist]() { return dist(gen); });
+
+        auto sorted = to_select;
+        std::sort(sorted.begin(), sorted.end());
+
+        auto kth = to_select.begin() + 12345;
+        alg::quick_select(to_select.begin(), kth, to_select.end());
+        REQUIRE(*kth == sorted[12345]);
+    }
+}
+
+TEST_CASE("quick_select") {
+    std::vector<int> sample_array(500);
+
+    std::uniform_int_distribution<> dist;
+    std::generate(sample_array.begin(), sample_array.end(), [&dist]() { return dist(gen); });
+
+    auto sorted = sample_array;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (std::size_t i = 0; i < sample_array.size(); ++i) {
+        auto current_pos = sample_array.begin() + i;
+        alg::quick_select(sample_array.begin(), current_pos, sample_array.end());
 
         REQUIRE(std::is_partitioned(sample_array.begin(), sample_array.end(), [current_pos](int a) {
             return a < *current_pos;
@@ -148,4 +1642,317 @@ TEST_CASE("quick_select") {
 
         REQUIRE(sample_array[i] == sorted[i]);
     }
+
+    auto check_select = [](std::vector<int> vec, std::size_t k) {
+        auto sorted = vec;
+        std::sort(sorted.begin(), sorted.end());
+
+        auto kth = vec.begin() + k;
+        alg::quick_select(vec.begin(), kth, vec.end());
+        REQUIRE(*kth == sorted[k]);
+        REQUIRE(std::all_of(vec.begin(), kth, [&](int x) { return x <= *kth; }));
+        REQUIRE(std::all_of(kth, vec.end(), [&](int x) { return x >= *kth; }));
+    };
+
+    for (std::size_t size : {24, 25, 129, 1000, 100000}) {
+        std::uniform_int_distribution<> few_values(0, 3);
+        std::vector<int> duplicates(size), ascending(size), organ_pipe(size);
+        std::generate(duplicates.begin(), duplicates.end(), [&]() { return few_values(gen); });
+        std::iota(ascending.begin(), ascending.end(), 0);
+        for (std::size_t i = 0; i < size; ++i) {
+            organ_pipe[i] = static_cast<int>(std::min(i, size - i));
+        }
+        std::vector<int> equal(size, 7);
+        std::vector<int> descending(ascending.rbegin(), ascending.rend());
+
+        for (std::size_t k : {std::size_t(0), size / 3, size / 2, size - 1}) {
+            SECTION("patterns, size = " + std::to_string(size) + ", k = " + std::to_string(k)) {
+                check_select(duplicates, k);
+                check_select(ascending, k);
+                check_select(descending, k);
+                check_select(organ_pipe, k);
+                check_select(equal, k);
+            }
+        }
+    }
+
+    SECTION("median of medians fallback") {
+        std::uniform_int_distribution<> dist(0, 50);
+        for (std::size_t size : {24, 100, 1001, 20000}) {
+            std::vector<int> vec(size);
+            std::generate(vec.begin(), vec.end(), [&]() { return dist(gen); });
+            auto sorted = vec;
+            std::sort(sorted.begin(), sorted.end());
+
+            // no bad partitions allowed, so every pivot is a median of medians
+            auto kth = vec.begin() + size / 3;
+            alg::detail::introselect_loop(vec.begin(), kth, vec.end(), std::less<int>(), 0, true);
+            REQUIRE(*kth == sorted[size / 3]);
+            REQUIRE(std::all_of(kth, vec.end(), [&](int x) { return x >= *kth; }));
+        }
+    }
+
+    SECTION("custom comparator and kth == last") {
+        std::vector<std::string> vec = {"d", "a", "c", "b", "e"};
+        alg::quick_select(vec.begin(), vec.begin() + 1, vec.end(), std::greater<std::string>());
+        REQUIRE(vec[1] == "d");
+        alg::quick_select(vec.begin(), vec.end(), vec.end());
+        std::vector<int> empty;
+        alg::quick_select(empty.begin(), empty.end(), empty.end());
+    }
+}
+
+TEST_CASE("multi_select & quantiles") {
+    using iterator = std::vector<int>::iterator;
+
+    for (std::size_t size : {1, 2, 23, 24, 200, 5000, 100000}) {
+        for (int distinct_values : {4, 1000000}) {
+            std::uniform_int_distribution<> dist(0, distinct_values - 1);
+            std::vector<int> vec(size);
+            std::generate(vec.begin(), vec.end(), [&]() { return dist(gen); });
+
+            auto sorted = vec;
+            std::sort(sorted.begin(), sorted.end());
+
+            SECTION("multi_select, size = " + std::to_string(size) + ", distinct values = " +
+                    std::to_string(distinct_values)) {
+                std::vector<std::size_t> ranks = {0, size / 2, size / 2, size * 9 / 10, size * 99 / 100, size - 1};
+                std::vector<iterator> kths;
+                for (auto rank : ranks) {
+                    kths.push_back(vec.begin() + rank);
+                }
+                kths.push_back(vec.end());  // ignored
+
+                alg::multi_select(vec.begin(), vec.end(), kths.begin(), kths.end());
+
+                for (auto rank : ranks) {
+                    auto kth = vec.begin() + rank;
+                    REQUIRE(*kth == sorted[rank]);
+                    REQUIRE(std::all_of(vec.begin(), kth, [&](int x) { return x <= *kth; }));
+                    REQUIRE(std::all_of(kth, vec.end(), [&](int x) { return x >= *kth; }));
+                }
+                std::sort(vec.begin(), vec.end());
+                REQUIRE(vec == sorted);
+            }
+
+            SECTION("quantiles, size = " + std::to_string(size) + ", distinct values = " +
+                    std::to_string(distinct_values)) {
+                std::vector<double> probabilities = {0.99, 0.5, 0.999, 0.9, 0.0, 1.0};
+                auto result = alg::quantiles(vec.begin(), vec.end(), probabilities);
+
+                REQUIRE(result.size() == probabilities.size());
+                for (std::size_t i = 0; i < probabilities.size(); ++i) {
+                    REQUIRE(result[i] == sorted[static_cast<std::size_t>(probabilities[i] * (size - 1))]);
+                }
+            }
+        }
+    }
+
+    SECTION("custom comparator") {
+        std::vector<int> vec(1000);
+        std::iota(vec.begin(), vec.end(), 0);
+        std::shuffle(vec.begin(), vec.end(), gen);
+
+        auto result = alg::quantiles(vec.begin(), vec.end(), {0.0, 0.5, 1.0}, std::greater<int>());
+        REQUIRE(result == std::vector<int>{999, 500, 0});
+    }
+
+    SECTION("invalid arguments") {
+        std::vector<int> vec = {1, 2, 3};
+        std::vector<int> empty;
+        REQUIRE_THROWS_AS(alg::quantiles(empty.begin(), empty.end(), {0.5}), std::invalid_argument);
+        REQUIRE_THROWS_AS(alg::quantiles(vec.begin(), vec.end(), {1.5}), std::invalid_argument);
+        REQUIRE_THROWS_AS(alg::quantiles(vec.begin(), vec.end(), {std::nan("")}), std::invalid_argument);
+    }
+}
+
+TEST_CASE("partial_sort & top_k") {
+    std::uniform_int_distribution<> dist(0, 1000);
+
+    for (std::size_t size : {0, 1, 2, 10, 1000, 5000}) {
+        std::vector<int> vec(size);
+        std::generate(vec.begin(), vec.end(), [&dist]() { return dist(gen); });
+
+        auto sorted = vec;
+        std::sort(sorted.begin(), sorted.end());
+
+        for (std::size_t k : {std::size_t(0), std::size_t(1), std::size_t(7), size / 2, size}) {
+            if (k > size) {
+                continue;
+            }
+            std::vector<int> expected(sorted.begin(), sorted.begin() + k);
+
+            SECTION("partial_sort, size = " + std::to_string(size) + ", k = " + std::to_string(k)) {
+                auto tmp = vec;
+                alg::partial_sort(tmp.begin(), tmp.begin() + k, tmp.end());
+                REQUIRE(std::equal(expected.begin(), expected.end(), tmp.begin()));
+
+                std::sort(tmp.begin(), tmp.end());
+                REQUIRE(tmp == sorted);
+            }
+
+            SECTION("partial_sort with a custom comparator, size = " + std::to_string(size) + ", k = " + std::to_string(k)) {
+                auto tmp = vec;
+                alg::partial_sort(tmp.begin(), tmp.begin() + k, tmp.end(), std::greater<int>());
+                REQUIRE(std::equal(sorted.rbegin(), sorted.rbegin() + k, tmp.begin()));
+            }
+
+            SECTION("partial_sort_copy, size = " + std::to_string(size) + ", k = " + std::to_string(k)) {
+                // the input is a list, read once
+                std::list<int> input(vec.begin(), vec.end());
+                std::vector<int> result(k + 3, -1);
+                auto end = alg::partial_sort_copy(input.begin(), input.end(), result.begin(), result.begin() + k);
+                REQUIRE(end == result.begin() + k);
+                REQUIRE(std::equal(expected.begin(), expected.end(), result.begin()));
+                REQUIRE(std::all_of(end, result.end(), [](int x) { return x == -1; }));
+            }
+
+            SECTION("top_k, size = " + std::to_string(size) + ", k = " + std::to_string(k)) {
+                alg::top_k<int> accumulator(k);
+                for (auto x : vec) {
+                    accumulator.push(x);
+                }
+                REQUIRE(accumulator.size() == k);
+                REQUIRE(accumulator.sorted() == expected);
+                REQUIRE(accumulator.take_sorted() == expected);
+                REQUIRE(accumulator.empty());
+            }
+
+            SECTION("top_k batch push, size = " + std::to_string(size) + ", k = " + std::to_string(k)) {
+                alg::top_k<int> accumulator(k);
+                auto mid = vec.begin() + vec.size() / 3;
+                accumulator.push(vec.begin(), mid);
+                accumulator.push(mid, vec.end());
+                REQUIRE(accumulator.sorted() == expected);
+            }
+        }
+
+        SECTION("partial_sort_copy into a larger output, size = " + std::to_string(size)) {
+            std::vector<int> result(size + 5);
+            auto end = alg::partial_sort_copy(vec.begin(), vec.end(), result.begin(), result.end());
+            REQUIRE(end == result.begin() + size);
+            REQUIRE(std::equal(sorted.begin(), sorted.end(), result.begin()));
+        }
+
+        SECTION("partial_sort_copy into an empty output, size = " + std::to_string(size)) {
+            std::vector<int> result;
+            auto end = alg::partial_sort_copy(vec.begin(), vec.end(), result.begin(), result.end());
+            REQUIRE(end == result.end());
+        }
+    }
+
+    SECTION("top_k threshold and move-only pushes") {
+        alg::top_k<std::string, std::greater<std::string>> accumulator(2);
+        REQUIRE(accumulator.push(std::string("b")));
+        REQUIRE(accumulator.push(std::string("a")));
+        REQUIRE(accumulator.full());
+        REQUIRE(accumulator.threshold() == "a");
+        REQUIRE_FALSE(accumulator.push(std::string("0")));
+        REQUIRE(accumulator.push(std::string("c")));
+        REQUIRE(accumulator.threshold() == "b");
+        REQUIRE(accumulator.sorted() == std::vector<std::string>{"c", "b"});
+    }
+}
+
+template <class T>
+static void write_file(const std::string& path, const std::vector<T>& records) {
+    auto file = std::fopen(path.c_str(), "wb");
+    REQUIRE(file != nullptr);
+    REQUIRE(std::fwrite(records.data(), sizeof(T), records.size(), file) == records.size());
+    std::fclose(file);
+}
+
+template <class T>
+static std::vector<T> read_file(const std::string& path) {
+    std::vector<T> records;
+
+    auto file = std::fopen(path.c_str(), "rb");
+    REQUIRE(file != nullptr);
+    T record;
+    while (std::fread(&record, sizeof(T), 1, file) == 1) {
+        records.push_back(record);
+    }
+    std::fclose(file);
+
+    return records;
+}
+
+TEST_CASE("external_sort") {
+    const std::string input_path  = "external_sort_test_input.bin";
+    const std::string output_path = "external_sort_test_output.bin";
+
+    std::vector<uint32_t> records(100000);
+    std::uniform_int_distribution<uint32_t> dist;
+    std::generate(records.begin(), records.end(), [&dist]() { return dist(gen); });
+    write_file(input_path, records);
+
+    auto sorted = records;
+    std::sort(sorted.begin(), sorted.end());
+
+    SECTION("several merge passes") {
+        // 5 runs, and 4 blocks of 64 KiB fit in the budget (2 for the output), so the runs are merged two at a time
+        REQUIRE(alg::detail::external_sort_fan_in(256 * 1024, sizeof(uint32_t)) == 2);
+        alg::external_sort<uint32_t>(input_path, output_path, 256 * 1024);
+        REQUIRE(read_file<uint32_t>(output_path) == sorted);
+    }
+    SECTION("single merge pass") {
+        REQUIRE(alg::detail::external_sort_fan_in(4 * 1024 * 1024, sizeof(uint32_t)) == 62);
+        alg::external_sort<uint32_t>(input_path, output_path, 4 * 1024 * 1024);
+        REQUIRE(read_file<uint32_t>(output_path) == sorted);
+    }
+    SECTION("descending") {
+        alg::external_sort<uint32_t>(input_path, output_path, 256 * 1024, std::greater<uint32_t>());
+        REQUIRE(std::equal(sorted.rbegin(), sorted.rend(), read_file<uint32_t>(output_path).begin()));
+    }
+    SECTION("budget smaller than a record") {
+        // 100 runs of one record, merged two at a time
+        REQUIRE(alg::detail::external_sort_fan_in(1, sizeof(uint32_t)) == 2);
+        REQUIRE(alg::detail::external_sort_fan_in(100 * 1024, sizeof(uint32_t)) == 2);
+
+        records.resize(100);
+        write_file(input_path, records);
+        alg::external_sort<uint32_t>(input_path, output_path, 1);
+        auto output = read_file<uint32_t>(output_path);
+        REQUIRE(output.size() == 100);
+        REQUIRE(std::is_sorted(output.begin(), output.end()));
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    SECTION("more runs than file descriptors") {
+        // 2000 runs of one record, which all go to a single temporary file per merge pass
+        records.resize(2000);
+        write_file(input_path, records);
+
+        rlimit limit;
+        REQUIRE(getrlimit(RLIMIT_NOFILE, &limit) == 0);
+        auto lowered     = limit;
+        lowered.rlim_cur = 64;
+        REQUIRE(setrlimit(RLIMIT_NOFILE, &lowered) == 0);
+        alg::external_sort<uint32_t>(input_path, output_path, 1);
+        REQUIRE(setrlimit(RLIMIT_NOFILE, &limit) == 0);
+
+        auto output = read_file<uint32_t>(output_path);
+        std::sort(records.begin(), records.end());
+        REQUIRE(output == records);
+    }
+#endif
+    SECTION("temporary directory") {
+        alg::external_sort<uint32_t>(input_path, output_path, 256 * 1024, std::less<uint32_t>(), ".");
+        REQUIRE(read_file<uint32_t>(output_path) == sorted);
+
+        REQUIRE_THROWS_AS(alg::external_sort<uint32_t>(
+                              input_path, output_path, 256 * 1024, std::less<uint32_t>(), "missing_directory"),
+                          std::runtime_error);
+    }
+    SECTION("empty file") {
+        write_file(input_path, std::vector<uint32_t>());
+        alg::external_sort<uint32_t>(input_path, output_path, 256 * 1024);
+        REQUIRE(read_file<uint32_t>(output_path).empty());
+    }
+    SECTION("missing file") {
+        REQUIRE_THROWS_AS(alg::external_sort<uint32_t>("missing_file.bin", output_path, 256 * 1024),
+                          std::runtime_error);
+    }
+
+    std::remove(input_path.c_str());
+    std::remove(output_path.c_str());
 }